@@ -0,0 +1,67 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_ACCUMULATORLAYOUT_H
+#define MANTARAY_ACCUMULATORLAYOUT_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace MantaRay
+{
+
+    /// \brief The memory layout of the two perspectives of an accumulator.
+    enum class AccumulatorLayout : uint8_t
+    {
+
+        /// \brief Every perspective is stored contiguously, white's before black's.
+        /// \details Kernels walk the perspectives one after the other, as two streams.
+        Split,
+
+        /// \brief The perspectives are stored in alternating cache-line chunks (white, black, white, ...).
+        /// \details Kernels walk both perspectives in a single pass over contiguous memory, as one stream.
+        Interleaved
+
+    };
+
+    /// \brief The placement of the values of both perspectives in the storage of an accumulator.
+    /// \tparam Layout The layout of the accumulator.
+    /// \tparam T The type of the values.
+    /// \tparam Size The number of values of a perspective.
+    template<AccumulatorLayout Layout, typename T, size_t Size>
+    class PerspectiveStorage
+    {
+
+        public:
+            /// \brief The number of values of a perspective stored together when interleaved, filling a cache line.
+            constexpr static size_t Chunk = 64 / sizeof(T);
+
+            static_assert(Layout == AccumulatorLayout::Split || Size % Chunk == 0,
+                          "An interleaved accumulator must hold whole chunks.");
+
+            /// \brief The number of values of a perspective that are contiguous in storage.
+            constexpr static size_t Run = Layout == AccumulatorLayout::Split ? Size : Chunk;
+
+            /// \brief The number of passes a kernel makes over the storage, and the perspectives handled by each.
+            constexpr static uint8_t Passes = Layout == AccumulatorLayout::Split ? 2 : 1;
+            constexpr static uint8_t PerPass = 2 / Passes;
+
+            /// \brief The index of a value of a perspective in the storage.
+            /// \param perspective The perspective, zero for white and one for black.
+            /// \param i The index of the value within the perspective.
+            /// \return The index of the value in the storage.
+            /// \details Runs of values of a perspective that don't cross a chunk boundary are contiguous in storage
+            ///          in both layouts, so SIMD registers are loaded from a single index.
+            [[nodiscard]] constexpr static inline size_t Index(const uint8_t perspective, const size_t i)
+            {
+                if constexpr (Layout == AccumulatorLayout::Split) return perspective * Size + i;
+                else return (i / Chunk) * Chunk * 2 + perspective * Chunk + i % Chunk;
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_ACCUMULATORLAYOUT_H
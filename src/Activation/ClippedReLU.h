@@ -29,18 +29,18 @@ namespace MantaRay
 
         public:
 #ifdef __AVX512BW__
-            static inline Vec512I Activate(const Vec512I& arg)
+            static inline Vec512<T> Activate(const Vec512<T>& arg)
             {
-                const Vec512I min = Avx512<T>::From(Minimum);
-                const Vec512I max = Avx512<T>::From(Maximum);
+                const Vec512<T> min = Avx512<T>::From(Minimum);
+                const Vec512<T> max = Avx512<T>::From(Maximum);
 
                 return Avx512<T>::Max(min, Avx512<T>::Min(max, arg));
             }
 #elifdef __AVX2__
-            static inline Vec256I Activate(const Vec256I& arg)
+            static inline Vec256<T> Activate(const Vec256<T>& arg)
             {
-                const Vec256I min = Avx<T>::From(Minimum);
-                const Vec256I max = Avx<T>::From(Maximum);
+                const Vec256<T> min = Avx<T>::From(Minimum);
+                const Vec256<T> max = Avx<T>::From(Maximum);
 
                 return Avx2<T>::Max(min, Avx2<T>::Min(max, arg));
             }
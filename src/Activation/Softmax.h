@@ -0,0 +1,103 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_SOFTMAX_H
+#define MANTARAY_SOFTMAX_H
+
+#include <array>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+namespace MantaRay
+{
+
+    /// \brief Fixed-point softmax function.
+    /// \details Calling the static Permille function will provide the softmax of the logits, rounded to permille so
+    ///          the probabilities always add up to exactly 1000. The exponentials are computed in Q16 fixed-point,
+    ///          which is deterministic across platforms and precise to about a tenth of a permille.
+    class Softmax
+    {
+
+        private:
+            // The fractional bits of the fixed-point values:
+            constexpr static int64_t Shift = 16;
+            constexpr static int64_t One   = int64_t(1) << Shift;
+
+            // log2(e) in Q16:
+            constexpr static int64_t Log2E = 94548;
+
+            // Logits further than this below the largest one contribute nothing at permille precision:
+            constexpr static int64_t Floor = -24 * One;
+
+            /// \brief Compute e raised to a non-positive Q16 power.
+            /// \param x The power, in Q16.
+            /// \return The exponential, in Q16.
+            /// \details The power is converted to base 2 and split into its integer part, which becomes a shift, and
+            ///          its fractional part, which is evaluated with a cubic polynomial approximating 2^f on [0, 1).
+            [[nodiscard]] constexpr static inline int64_t Exp(const int64_t x)
+            {
+                const int64_t y = std::max(x, Floor) * Log2E >> Shift;
+
+                // Split the base 2 power into y = k + f, with f in [0, 1):
+                const int64_t k = y >> Shift;
+                const int64_t f = y - k * One;
+
+                // 2^f ~= 1 + f * (0.69570 + f * (0.22617 + f * 0.07813)):
+                int64_t p = 5120;
+                p = 14822 + (p * f >> Shift);
+                p = 45593 + (p * f >> Shift);
+                p = One   + (p * f >> Shift);
+
+                return p >> -k;
+            }
+
+        public:
+            /// \brief Compute the softmax of the logits, in permille.
+            /// \tparam OT The type of the logits.
+            /// \tparam N The number of logits.
+            /// \param logits The logits.
+            /// \param one The value of a logit of one, such as the product of the quantization factors.
+            /// \return The probabilities, in permille, adding up to exactly 1000.
+            template<typename OT, size_t N>
+            [[nodiscard]] static std::array<uint16_t, N> Permille(const std::array<OT, N>& logits, const OT one)
+            {
+                const OT max = *std::max_element(logits.begin(), logits.end());
+
+                // Exponentiate the logits relative to the largest one, so the exponentials never overflow:
+                std::array<int64_t, N> e;
+                int64_t sum = 0;
+
+                for (size_t i = 0; i < N; i++) {
+                    int64_t x;
+                    if constexpr (std::is_floating_point_v<OT>)
+                        x = static_cast<int64_t>(std::max<OT>((logits[i] - max) / one, Floor / One) * One);
+                    else
+                        x = (static_cast<int64_t>(logits[i]) - max) * One / one;
+
+                    e[i] = Exp(x);
+                    sum += e[i];
+                }
+
+                // Round the probabilities, giving what rounding lost or gained to the most likely outcome:
+                std::array<uint16_t, N> probability;
+                int64_t total = 0;
+
+                for (size_t i = 0; i < N; i++) {
+                    probability[i] = static_cast<uint16_t>((e[i] * 1000 + sum / 2) / sum);
+                    total += probability[i];
+                }
+
+                const size_t likely = std::max_element(e.begin(), e.end()) - e.begin();
+                probability[likely] = static_cast<uint16_t>(probability[likely] + 1000 - total);
+
+                return probability;
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_SOFTMAX_H
@@ -0,0 +1,161 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_ASYNCNETWORK_H
+#define MANTARAY_ASYNCNETWORK_H
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace MantaRay
+{
+
+    /// \brief A handle to a network that is loaded in the background.
+    /// \tparam Network The network type to load.
+    /// \details Loading a network, especially one that has to be quantized and permuted, can take long enough to
+    ///          delay an engine's startup. This handle starts loading the network on a worker thread and returns
+    ///          immediately, allowing the engine to keep answering its protocol in the meantime. Once the network is
+    ///          ready, its accumulators must be refreshed before the first evaluation, as any updates made before
+    ///          readiness could not have been applied, which is why evaluations only switch to it explicitly.
+    template<typename Network>
+    class AsyncNetwork
+    {
+
+        private:
+            using OutputType = decltype(std::declval<Network&>().Evaluate(0));
+
+            std::shared_future<std::shared_ptr<Network>> Loading;
+
+            Network* Instance = nullptr;
+
+            // The exception loading failed with, caught once so that polling never rethrows it:
+            std::exception_ptr Failure = nullptr;
+
+            // The network once the caller switched to it, until which the fallback is evaluated:
+            Network* Active = nullptr;
+
+            explicit AsyncNetwork(std::shared_future<std::shared_ptr<Network>> loading) :
+            Loading(std::move(loading)) {}
+
+            void Settle()
+            {
+                try {
+                    Instance = Loading.get().get();
+                } catch (...) {
+                    Failure = std::current_exception();
+                }
+            }
+
+        public:
+            /// \brief Start loading a network in the background.
+            /// \tparam Stream The stream type to load the network from, such as MantaRay::BinaryFileStream or
+            ///                MantaRay::MarlinflowStream.
+            /// \param path The path to the network file.
+            /// \return A handle to the network being loaded.
+            /// \details The stream is opened, read, and the network constructed from it on a worker thread. This
+            ///          function doesn't wait for any of it.
+            template<typename Stream>
+            __attribute__((unused)) static AsyncNetwork Load(const std::string& path)
+            {
+                return AsyncNetwork(std::async(std::launch::async, [path] {
+                    Stream stream(path);
+                    return std::make_shared<Network>(stream);
+                }).share());
+            }
+
+            /// \brief The future that becomes ready once the network is loaded.
+            /// \return A shared future that can be waited on from any thread.
+            [[nodiscard]] __attribute__((unused)) std::shared_future<std::shared_ptr<Network>> Ready() const
+            {
+                return Loading;
+            }
+
+            /// \brief Whether the network has finished loading.
+            /// \return True if the network can be used without blocking, or false if it is still loading or loading
+            ///         failed, which MantaRay::AsyncNetwork::Failed tells apart.
+            [[nodiscard]] __attribute__((unused)) bool IsReady()
+            {
+                if (Instance != nullptr) return true;
+                if (Failure != nullptr) return false;
+
+                if (Loading.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+
+                Settle();
+                return Instance != nullptr;
+            }
+
+            /// \brief Whether loading the network failed.
+            /// \return True if loading threw, in which case the network will never become ready.
+            /// \details This function never blocks.
+            [[nodiscard]] __attribute__((unused)) bool Failed()
+            {
+                return !IsReady() && Failure != nullptr;
+            }
+
+            /// \brief The exception loading the network failed with.
+            /// \return The exception, or nullptr if loading hasn't failed (yet).
+            /// \details This function never blocks.
+            [[nodiscard]] __attribute__((unused)) std::exception_ptr Error()
+            {
+                return Failed() ? Failure : nullptr;
+            }
+
+            /// \brief Get the network, blocking until it is loaded.
+            /// \return The loaded network.
+            /// \throws The exception loading the network failed with, such as std::runtime_error for a missing or
+            ///         malformed file, on every call once loading failed.
+            __attribute__((unused)) Network& Wait()
+            {
+                if (Instance == nullptr && Failure == nullptr) Settle();
+                if (Failure != nullptr) std::rethrow_exception(Failure);
+
+                return *Instance;
+            }
+
+            /// \brief Get the network if it is loaded.
+            /// \return The loaded network, or nullptr if it is still loading or loading failed.
+            /// \details This function never blocks nor throws.
+            __attribute__((unused)) Network* TryGet()
+            {
+                return IsReady() ? Instance : nullptr;
+            }
+
+            /// \brief Switch evaluations to the network if it is loaded.
+            /// \return The network that evaluations switched to, or nullptr if it is still loading or loading failed.
+            /// \details This function never blocks nor throws. The network's accumulator must be refreshed right after
+            ///          switching, before the next evaluation, such as at the root of the next search.
+            __attribute__((unused)) Network* Activate()
+            {
+                if (Active == nullptr && IsReady()) Active = Instance;
+
+                return Active;
+            }
+
+            /// \brief Evaluate the network, or fall back until evaluations switched to it.
+            /// \tparam Fallback The type of the fallback evaluation.
+            /// \param colorToMove The color to move.
+            /// \param fallback The evaluation to use until MantaRay::AsyncNetwork::Activate switched to the network,
+            ///                 such as a classical evaluation, called without arguments.
+            /// \return The evaluation of the network, or the fallback evaluation.
+            /// \details This function never blocks. The network becoming ready doesn't switch evaluations to it, as
+            ///          its accumulator would not have been refreshed yet.
+            template<typename Fallback>
+            __attribute__((unused)) inline OutputType EvaluateOr(const uint8_t colorToMove, Fallback&& fallback)
+            {
+                if (Active == nullptr) return static_cast<OutputType>(fallback());
+
+                return Active->Evaluate(colorToMove);
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_ASYNCNETWORK_H
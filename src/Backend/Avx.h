@@ -78,6 +78,90 @@ namespace MantaRay
                 _mm256_store_si256((Vec256I *) &array[index], ymm0);
             }
 
+            /// \brief Store an AVX register at a potentially unaligned address.
+            /// \param ymm0 The AVX register to store.
+            /// \param address The address to begin storing at.
+            /// \details This function stores the provided AVX register at the provided address, which doesn't need
+            ///          to be aligned. The address must have at least 32 bytes of memory allocated.
+            static inline void StoreUnaligned(const Vec256I& ymm0, T* address)
+            {
+                _mm256_storeu_si256((Vec256I *) address, ymm0);
+            }
+
+    };
+
+    /// \brief AVX Intrinsics wrapper for single-precision floating-point data.
+    /// \details This specialization wraps the floating-point AVX intrinsics, which operate on Vec256F registers
+    ///          instead of the integer registers used for the other types.
+    template<>
+    class Avx<float>
+    {
+
+        public:
+            /// \brief Load an AVX register with zeros.
+            /// \return An AVX register filled with zeros.
+            static inline Vec256F Zero()
+            {
+                return _mm256_setzero_ps();
+            }
+
+            /// \brief Load an AVX register with the provided value.
+            /// \param value The value to load into the register.
+            /// \return An AVX register with the provided value duplicated across the register.
+            static inline Vec256F From(const float value)
+            {
+                return _mm256_set1_ps(value);
+            }
+
+            /// \brief Load an AVX register from a potentially unaligned address.
+            /// \param address The address to begin loading from.
+            /// \return An AVX register loaded from the provided address.
+            /// \details The address must have at least 32 bytes of memory allocated.
+            static inline Vec256F FromUnaligned(const float* address)
+            {
+                return _mm256_loadu_ps(address);
+            }
+
+            /// \brief Load an AVX register from an array.
+            /// \tparam Size The size of the array.
+            /// \param array The array to load from.
+            /// \param index The index to begin loading from, which must be aligned to 32 bytes.
+            /// \return An AVX register loaded from the array starting at the provided index.
+            template<size_t Size>
+            static inline Vec256F From(const std::array<float, Size>& array, const uint32_t index)
+            {
+                return _mm256_load_ps(&array[index]);
+            }
+
+            /// \brief Store an AVX register into an array.
+            /// \tparam Size The size of the array.
+            /// \param ymm0 The AVX register to store.
+            /// \param array The array to store into.
+            /// \param index The index to begin storing at, which must be aligned to 32 bytes.
+            template<size_t Size>
+            static inline void Store(const Vec256F& ymm0, std::array<float, Size>& array, const uint32_t index)
+            {
+                _mm256_store_ps(&array[index], ymm0);
+            }
+
+            /// \brief Vertically multiply the two provided registers.
+            /// \param ymm0 The first register.
+            /// \param ymm1 The second register.
+            /// \return A register with the product of the two provided registers.
+            static inline Vec256F Multiply(const Vec256F& ymm0, const Vec256F& ymm1)
+            {
+                return _mm256_mul_ps(ymm0, ymm1);
+            }
+
+            /// \brief Convert the provided register to 32-bit integers.
+            /// \param ymm0 The register to convert.
+            /// \return An integer register with the converted values.
+            /// \details The values are truncated towards zero, matching a plain integer cast.
+            static inline Vec256I ConvertToInt32(const Vec256F& ymm0)
+            {
+                return _mm256_cvttps_epi32(ymm0);
+            }
+
     };
 
 } // MantaRay
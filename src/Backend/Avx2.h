@@ -107,6 +107,20 @@ namespace MantaRay
                 return _mm256_madd_epi16(ymm0, ymm1);
             }
 
+            /// \brief Pack the two provided registers into a register of half-width values using saturation.
+            /// \param ymm0 The first register, providing the lower half of the packed values.
+            /// \param ymm1 The second register, providing the upper half of the packed values.
+            /// \return A register with the values of both registers saturated to half of the bits of the provided
+            ///         type.
+            /// \details The packing instruction interleaves the 128-bit lanes of the two registers, so the result is
+            ///          permuted back to keep the values in the order they were provided in.
+            static inline Vec256I Pack(const Vec256I& ymm0, const Vec256I& ymm1)
+            {
+                static_assert(std::is_same_v<T, int32_t>, "Unsupported type provided.");
+
+                return _mm256_permute4x64_epi64(_mm256_packs_epi32(ymm0, ymm1), _MM_SHUFFLE(3, 1, 2, 0));
+            }
+
             /// \brief Horizontally add the values of the provided register.
             /// \param ymm0 The register.
             /// \return The sum of the values of the provided register.
@@ -145,6 +159,85 @@ namespace MantaRay
 
     };
 
+    /// \brief AVX2 Intrinsics wrapper for single-precision floating-point data.
+    /// \details The floating-point arithmetic is part of AVX already, but it is wrapped here so kernels written
+    ///          against the AVX2 interface work for floats as well.
+    template<>
+    class Avx2<float>
+    {
+
+        public:
+            /// \brief Get a register with the minimum cross-register values of the two provided registers.
+            /// \param ymm0 The first register.
+            /// \param ymm1 The second register.
+            /// \return A register with the minimum values of the two provided registers.
+            static inline Vec256F Min(const Vec256F& ymm0, const Vec256F& ymm1)
+            {
+                return _mm256_min_ps(ymm0, ymm1);
+            }
+
+            /// \brief Get a register with the maximum cross-register values of the two provided registers.
+            /// \param ymm0 The first register.
+            /// \param ymm1 The second register.
+            /// \return A register with the maximum values of the two provided registers.
+            static inline Vec256F Max(const Vec256F& ymm0, const Vec256F& ymm1)
+            {
+                return _mm256_max_ps(ymm0, ymm1);
+            }
+
+            /// \brief Vertically add the two provided registers.
+            /// \param ymm0 The first register.
+            /// \param ymm1 The second register.
+            /// \return A register with the sum of the two provided registers.
+            static inline Vec256F Add(const Vec256F& ymm0, const Vec256F& ymm1)
+            {
+                return _mm256_add_ps(ymm0, ymm1);
+            }
+
+            /// \brief Vertically subtract the two provided registers.
+            /// \param ymm0 The first register.
+            /// \param ymm1 The second register.
+            /// \return A register with the difference of the two provided registers.
+            static inline Vec256F Subtract(const Vec256F& ymm0, const Vec256F& ymm1)
+            {
+                return _mm256_sub_ps(ymm0, ymm1);
+            }
+
+            /// \brief Multiply the first two provided registers and add the third.
+            /// \param ymm0 The first factor.
+            /// \param ymm1 The second factor.
+            /// \param ymm2 The addend.
+            /// \return A register with ymm0 * ymm1 + ymm2.
+            /// \details The multiplication and addition are fused into a single instruction when FMA is available,
+            ///          which rounds once instead of twice.
+            static inline Vec256F MultiplyAdd(const Vec256F& ymm0, const Vec256F& ymm1, const Vec256F& ymm2)
+            {
+#ifdef __FMA__
+                return _mm256_fmadd_ps(ymm0, ymm1, ymm2);
+#else
+                return _mm256_add_ps(_mm256_mul_ps(ymm0, ymm1), ymm2);
+#endif
+            }
+
+            /// \brief Horizontally add the values of the provided register.
+            /// \param ymm0 The register.
+            /// \return The sum of the values of the provided register.
+            /// \details The upper and lower halves are added vertically, after which the remaining four values are
+            ///          added pairwise.
+            static inline float Sum(const Vec256F& ymm0)
+            {
+                // Add the lower and upper half vertically:
+                Vec128F xmm0 = _mm_add_ps(_mm256_castps256_ps128(ymm0), _mm256_extractf128_ps(ymm0, 1));
+
+                // Add the remaining values pairwise:
+                xmm0 = _mm_add_ps(xmm0, _mm_movehl_ps(xmm0, xmm0));
+                xmm0 = _mm_add_ss(xmm0, _mm_movehdup_ps(xmm0));
+
+                return _mm_cvtss_f32(xmm0);
+            }
+
+    };
+
 } // MantaRay
 
 #endif //MANTARAY_AVX2_H
@@ -72,6 +72,16 @@ namespace MantaRay
                 _mm512_store_si512((Vec512I *) &array[index], zmm0);
             }
 
+            /// \brief Store an AVX512 register at a potentially unaligned address.
+            /// \param zmm0 The AVX512 register to store.
+            /// \param address The address to begin storing at.
+            /// \details This function stores the provided AVX512 register at the provided address, which doesn't
+            ///          need to be aligned. The address must have at least 64 bytes of memory allocated.
+            static inline void StoreUnaligned(const Vec512I& zmm0, T* address)
+            {
+                _mm512_storeu_si512((Vec512I *) address, zmm0);
+            }
+
             /// \brief Get a register with the minimum cross-register values of the two provided registers.
             /// \param ymm0 The first register.
             /// \param ymm1 The second register.
@@ -156,6 +166,21 @@ namespace MantaRay
                 return _mm512_madd_epi16(zmm0, zmm1);
             }
 
+            /// \brief Pack the two provided registers into a register of half-width values using saturation.
+            /// \param zmm0 The first register, providing the lower half of the packed values.
+            /// \param zmm1 The second register, providing the upper half of the packed values.
+            /// \return A register with the values of both registers saturated to half of the bits of the provided
+            ///         type.
+            /// \details The packing instruction interleaves the 128-bit lanes of the two registers, so the result is
+            ///          permuted back to keep the values in the order they were provided in.
+            static inline Vec512I Pack(const Vec512I& zmm0, const Vec512I& zmm1)
+            {
+                static_assert(std::is_same_v<T, int32_t>, "Unsupported type provided.");
+
+                const Vec512I order = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
+                return _mm512_permutexvar_epi64(order, _mm512_packs_epi32(zmm0, zmm1));
+            }
+
             /// \brief Horizontally add the values of the provided register.
             /// \param ymm0 The register.
             /// \return The sum of the values of the provided register.
@@ -185,6 +210,139 @@ namespace MantaRay
 
     };
 
+    /// \brief AVX512 Intrinsics wrapper for single-precision floating-point data.
+    /// \details This specialization wraps the floating-point AVX512 intrinsics, which operate on Vec512F registers
+    ///          instead of the integer registers used for the other types.
+    template<>
+    class Avx512<float>
+    {
+
+        public:
+            /// \brief Load an AVX512 register with zeros.
+            /// \return An AVX512 register filled with zeros.
+            static inline Vec512F Zero()
+            {
+                return _mm512_setzero_ps();
+            }
+
+            /// \brief Load an AVX512 register with the provided value.
+            /// \param value The value to load into the register.
+            /// \return An AVX512 register with the provided value duplicated across the register.
+            static inline Vec512F From(const float value)
+            {
+                return _mm512_set1_ps(value);
+            }
+
+            /// \brief Load an AVX512 register from a potentially unaligned address.
+            /// \param address The address to begin loading from.
+            /// \return An AVX512 register loaded from the provided address.
+            /// \details The address must have at least 64 bytes of memory allocated.
+            static inline Vec512F FromUnaligned(const float* address)
+            {
+                return _mm512_loadu_ps(address);
+            }
+
+            /// \brief Load an AVX512 register from an array.
+            /// \tparam Size The size of the array.
+            /// \param array The array to load from.
+            /// \param index The index to begin loading from, which must be aligned to 64 bytes.
+            /// \return An AVX512 register loaded from the array starting at the provided index.
+            template<size_t Size>
+            static inline Vec512F From(const std::array<float, Size>& array, const uint32_t index)
+            {
+                return _mm512_load_ps(&array[index]);
+            }
+
+            /// \brief Store an AVX512 register into an array.
+            /// \tparam Size The size of the array.
+            /// \param zmm0 The AVX512 register to store.
+            /// \param array The array to store into.
+            /// \param index The index to begin storing at, which must be aligned to 64 bytes.
+            template<size_t Size>
+            static inline void Store(const Vec512F& zmm0, std::array<float, Size>& array, const uint32_t index)
+            {
+                _mm512_store_ps(&array[index], zmm0);
+            }
+
+            /// \brief Get a register with the minimum cross-register values of the two provided registers.
+            /// \param zmm0 The first register.
+            /// \param zmm1 The second register.
+            /// \return A register with the minimum values of the two provided registers.
+            static inline Vec512F Min(const Vec512F& zmm0, const Vec512F& zmm1)
+            {
+                return _mm512_min_ps(zmm0, zmm1);
+            }
+
+            /// \brief Get a register with the maximum cross-register values of the two provided registers.
+            /// \param zmm0 The first register.
+            /// \param zmm1 The second register.
+            /// \return A register with the maximum values of the two provided registers.
+            static inline Vec512F Max(const Vec512F& zmm0, const Vec512F& zmm1)
+            {
+                return _mm512_max_ps(zmm0, zmm1);
+            }
+
+            /// \brief Vertically add the two provided registers.
+            /// \param zmm0 The first register.
+            /// \param zmm1 The second register.
+            /// \return A register with the sum of the two provided registers.
+            static inline Vec512F Add(const Vec512F& zmm0, const Vec512F& zmm1)
+            {
+                return _mm512_add_ps(zmm0, zmm1);
+            }
+
+            /// \brief Vertically subtract the two provided registers.
+            /// \param zmm0 The first register.
+            /// \param zmm1 The second register.
+            /// \return A register with the difference of the two provided registers.
+            static inline Vec512F Subtract(const Vec512F& zmm0, const Vec512F& zmm1)
+            {
+                return _mm512_sub_ps(zmm0, zmm1);
+            }
+
+            /// \brief Multiply the first two provided registers and add the third, in a single fused instruction.
+            /// \param zmm0 The first factor.
+            /// \param zmm1 The second factor.
+            /// \param zmm2 The addend.
+            /// \return A register with zmm0 * zmm1 + zmm2.
+            static inline Vec512F MultiplyAdd(const Vec512F& zmm0, const Vec512F& zmm1, const Vec512F& zmm2)
+            {
+                return _mm512_fmadd_ps(zmm0, zmm1, zmm2);
+            }
+
+            /// \brief Horizontally add the values of the provided register.
+            /// \param zmm0 The register.
+            /// \return The sum of the values of the provided register.
+            /// \details The lower and upper halves are added vertically, and the AVX2 implementation sums the rest.
+            /// \see MantaRay::Backend::Avx2<float>::Sum(const Vec256F& ymm0)
+            static inline float Sum(const Vec512F& zmm0)
+            {
+                const Vec256F ymm0 = _mm256_add_ps(_mm512_castps512_ps256(zmm0),
+                                                   _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(zmm0), 1)));
+
+                return Avx2<float>::Sum(ymm0);
+            }
+
+            /// \brief Vertically multiply the two provided registers.
+            /// \param zmm0 The first register.
+            /// \param zmm1 The second register.
+            /// \return A register with the product of the two provided registers.
+            static inline Vec512F Multiply(const Vec512F& zmm0, const Vec512F& zmm1)
+            {
+                return _mm512_mul_ps(zmm0, zmm1);
+            }
+
+            /// \brief Convert the provided register to 32-bit integers.
+            /// \param zmm0 The register to convert.
+            /// \return An integer register with the converted values.
+            /// \details The values are truncated towards zero, matching a plain integer cast.
+            static inline Vec512I ConvertToInt32(const Vec512F& zmm0)
+            {
+                return _mm512_cvttps_epi32(zmm0);
+            }
+
+    };
+
 } // MantaRay
 
 #endif //MANTARAY_AVX512_H
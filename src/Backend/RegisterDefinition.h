@@ -12,11 +12,39 @@
 using Vec512I = __m512i;
 using Vec256I = __m256i;
 using Vec128I = __m128i;
+
+using Vec512F = __m512;
+using Vec256F = __m256;
+using Vec128F = __m128;
+
+// The register holding values of a type, which is a floating-point register for floats and an integer one otherwise.
+// Specializations are used rather than std::conditional_t, as passing the registers as template arguments would drop
+// their vector attributes:
+template<typename T> struct Vec512Of { using type = Vec512I; };
+template<> struct Vec512Of<float> { using type = Vec512F; };
+template<typename T> struct Vec256Of { using type = Vec256I; };
+template<> struct Vec256Of<float> { using type = Vec256F; };
+
+template<typename T> using Vec512 = typename Vec512Of<T>::type;
+template<typename T> using Vec256 = typename Vec256Of<T>::type;
 #elif __AVX__
 using Vec256I = __m256i;
 using Vec128I = __m128i;
+
+using Vec256F = __m256;
+using Vec128F = __m128;
+
+// The register holding values of a type, which is a floating-point register for floats and an integer one otherwise.
+// Specializations are used rather than std::conditional_t, as passing the registers as template arguments would drop
+// their vector attributes:
+template<typename T> struct Vec256Of { using type = Vec256I; };
+template<> struct Vec256Of<float> { using type = Vec256F; };
+
+template<typename T> using Vec256 = typename Vec256Of<T>::type;
 #elif __SSE__
 using Vec128I = __m128i;
+
+using Vec128F = __m128;
 #endif
 
 #endif //MANTARAY_REGISTERDEFINITION_H
@@ -0,0 +1,72 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_COMMANDLINE_H
+#define MANTARAY_COMMANDLINE_H
+
+#include <cmath>
+#include <cctype>
+#include <string>
+#include <cstddef>
+#include <cstdlib>
+#include <charconv>
+
+namespace MantaRay
+{
+
+    /// \brief Parsing of the numeric values given to the command-line tools.
+    /// \details The values are parsed without exceptions, and only plain decimal numbers within the given bounds are
+    ///          accepted. In particular, a leading '-' is rejected rather than wrapped around, as std::stoul does.
+    class CommandLine
+    {
+
+        public:
+            /// \brief Parse a count or size.
+            /// \param value The value given on the command line.
+            /// \param result The parsed count, which is only written if it is accepted.
+            /// \param minimum The smallest count accepted.
+            /// \param maximum The largest count accepted.
+            /// \return Whether the value is a decimal number between the minimum and the maximum.
+            [[nodiscard]] __attribute__((unused)) static bool ParseCount(const std::string& value, size_t& result,
+                                                                         const size_t minimum, const size_t maximum)
+            {
+                size_t count;
+
+                // Unsigned parsing accepts neither a sign nor whitespace, and the whole value must be the number:
+                const char* end = value.data() + value.size();
+                const auto [last, error] = std::from_chars(value.data(), end, count);
+                if (error != std::errc() || last != end || count < minimum || count > maximum) return false;
+
+                result = count;
+                return true;
+            }
+
+            /// \brief Parse a positive number, such as a scale or a quantization factor.
+            /// \param value The value given on the command line.
+            /// \param result The parsed number, which is only written if it is accepted.
+            /// \param maximum The largest number accepted.
+            /// \return Whether the value is a finite number greater than zero and at most the maximum.
+            [[nodiscard]] __attribute__((unused)) static bool ParseNumber(const std::string& value, double& result,
+                                                                          const double maximum)
+            {
+                // Reject signs, whitespace, and the names of infinities and NaNs up front:
+                if (value.empty() || (!std::isdigit(static_cast<unsigned char>(value.front())) && value.front() != '.'))
+                    return false;
+
+                // std::strtod is used, as not every standard library parses floating-point numbers with from_chars:
+                char* end;
+                const double number = std::strtod(value.c_str(), &end);
+                if (end != value.c_str() + value.size() || !std::isfinite(number) || number <= 0 || number > maximum)
+                    return false;
+
+                result = number;
+                return true;
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_COMMANDLINE_H
@@ -0,0 +1,316 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#include "IO/MarlinflowStream.h"
+#include "IO/BinaryFileStream.h"
+#include "IO/FloatBinaryStream.h"
+#include "Perspective/Position.h"
+#include "Quantizer.h"
+#include "CommandLine.h"
+
+#include <iostream>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+// Offline conversion tool turning trainer output into the MantaRay binary network format.
+
+struct ConverterOptions
+{
+
+    std::string Input;
+    std::string Output;
+    std::string Suite;
+
+    size_t InputSize  = 768;
+    size_t HiddenSize = 256;
+    size_t OutputSize = 1  ;
+
+    double Scale               = 400;
+    double QuantizationFeature = 255;
+    double QuantizationOutput  = 64 ;
+
+    bool FloatInput = false;
+
+    MantaRay::QuantizationRounding Rounding = MantaRay::QuantizationRounding::Truncate;
+
+};
+
+struct FloatNetwork
+{
+
+    std::vector<float> FeatureWeight;
+    std::vector<float> FeatureBias  ;
+    std::vector<float> OutputWeight ;
+    std::vector<float> OutputBias   ;
+
+};
+
+struct QuantizedNetwork
+{
+
+    std::vector<int16_t> FeatureWeight;
+    std::vector<int16_t> FeatureBias  ;
+    std::vector<int16_t> OutputWeight ;
+    std::vector<int16_t> OutputBias   ;
+
+};
+
+void PrintUsage()
+{
+    std::cout << "Usage: MantaRayConverter --input <network> --output <network.nnue> [options]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --format <format>        Input format: marlinflow (default) or float."             << std::endl;
+    std::cout << "  --hidden <size>          Hidden layer size (default 256)."                       << std::endl;
+    std::cout << "  --outputs <size>         Output layer size (default 1)."                         << std::endl;
+    std::cout << "  --scale <value>          Evaluation scale (default 400)."                        << std::endl;
+    std::cout << "  --qa <value>             Feature quantization factor (default 255)."             << std::endl;
+    std::cout << "  --qb <value>             Output quantization factor (default 64)."               << std::endl;
+    std::cout << "  --rounding <mode>        Quantization rounding: truncate or nearest."            << std::endl;
+    std::cout << "  --verify <suite>         FEN file to evaluate with the float and quantized nets." << std::endl;
+}
+
+bool ParseOptions(const int argc, char** argv, ConverterOptions& options)
+{
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+
+        // Every option takes exactly one value:
+        if (i + 1 >= argc) return false;
+        const std::string value = argv[++i];
+
+        if      (arg == "--input"  ) options.Input  = value;
+        else if (arg == "--output" ) options.Output = value;
+        else if (arg == "--verify" ) options.Suite  = value;
+        else if (arg == "--hidden" ) {
+            if (!MantaRay::CommandLine::ParseCount (value, options.HiddenSize         , 1, 1 << 16)) return false;
+        }
+        else if (arg == "--outputs") {
+            if (!MantaRay::CommandLine::ParseCount (value, options.OutputSize         , 1, 1 << 8 )) return false;
+        }
+        else if (arg == "--scale"  ) {
+            if (!MantaRay::CommandLine::ParseNumber(value, options.Scale              , 1 << 20   )) return false;
+        }
+        else if (arg == "--qa"     ) {
+            // The quantized weights are 16-bit, so larger factors would overflow every weight:
+            if (!MantaRay::CommandLine::ParseNumber(value, options.QuantizationFeature, INT16_MAX )) return false;
+        }
+        else if (arg == "--qb"     ) {
+            if (!MantaRay::CommandLine::ParseNumber(value, options.QuantizationOutput , INT16_MAX )) return false;
+        }
+        else if (arg == "--format" ) {
+            if      (value == "marlinflow") options.FloatInput = false;
+            else if (value == "float"     ) options.FloatInput = true ;
+            else return false;
+        }
+        else if (arg == "--rounding") {
+            if      (value == "truncate") options.Rounding = MantaRay::QuantizationRounding::Truncate;
+            else if (value == "nearest" ) options.Rounding = MantaRay::QuantizationRounding::Nearest ;
+            else return false;
+        }
+        else return false;
+    }
+
+    return !options.Input.empty() && !options.Output.empty();
+}
+
+bool ReadMarlinflow(const ConverterOptions& options, FloatNetwork& floating)
+{
+    const size_t hiddenSize = options.HiddenSize;
+
+    MantaRay::MarlinflowStream input(options.Input);
+    input.Bind2DArray("ft.weight" , floating.FeatureWeight.data(), floating.FeatureWeight.size(), hiddenSize    , 1,
+                      true );
+    input.Bind2DArray("out.weight", floating.OutputWeight .data(), floating.OutputWeight .size(), hiddenSize * 2, 1,
+                      false);
+    input.BindArray("ft.bias" , floating.FeatureBias.data(), floating.FeatureBias.size(), 1);
+    input.BindArray("out.bias", floating.OutputBias .data(), floating.OutputBias .size(), 1);
+
+    return input.Parse();
+}
+
+bool ReadFloatBinary(const ConverterOptions& options, FloatNetwork& floating)
+{
+    MantaRay::FloatBinaryStream input(options.Input);
+    input.Read2DArray(floating.FeatureWeight.data(), options.HiddenSize, options.InputSize     , 1, true );
+    input.ReadArray  (floating.FeatureBias  .data(), floating.FeatureBias.size()              , 1       );
+    input.Read2DArray(floating.OutputWeight .data(), options.OutputSize, options.HiddenSize * 2, 1, false);
+    input.ReadArray  (floating.OutputBias   .data(), floating.OutputBias .size()              , 1       );
+
+    return input.Good();
+}
+
+void Quantize(MantaRay::Quantizer<int16_t>& quantizer, const std::vector<float>& input,
+              std::vector<int16_t>& output, const double K)
+{
+    output.resize(input.size());
+    for (size_t i = 0; i < input.size(); i++) output[i] = quantizer.Quantize(input[i], K);
+}
+
+void Report(const std::string& name, const MantaRay::Quantizer<int16_t>& quantizer)
+{
+    std::cout << " | " << name << ": " << quantizer.Count() << " values, " << quantizer.Saturated()
+              << " saturated, max rounding error " << quantizer.MaxError() << std::endl;
+}
+
+// Accumulate the hidden layer of one perspective from its bias and active features.
+template<typename T, typename AT>
+void Accumulate(const std::vector<T>& weight, const std::vector<T>& bias, const uint16_t* features,
+                const size_t count, const size_t hiddenSize, std::vector<AT>& accumulator)
+{
+    accumulator.assign(bias.begin(), bias.end());
+    for (size_t f = 0; f < count; f++)
+        for (size_t h = 0; h < hiddenSize; h++) accumulator[h] += weight[features[f] * hiddenSize + h];
+}
+
+void Verify(const ConverterOptions& options, const FloatNetwork& floating, const QuantizedNetwork& quantized)
+{
+    std::ifstream suite(options.Suite);
+
+    const size_t hiddenSize = options.HiddenSize;
+    const size_t outputSize = options.OutputSize;
+    const double QA = options.QuantizationFeature;
+    const double QB = options.QuantizationOutput;
+
+    MantaRay::Position position;
+    std::array<uint16_t, MantaRay::Position::MaxPieces> white {}, black {};
+    std::vector<double > floatWhite, floatBlack;
+    std::vector<int32_t> quantWhite, quantBlack;
+
+    size_t positions = 0, saturated = 0, zeroed = 0, overflowed = 0;
+    double errorSum  = 0, errorMax = 0;
+
+    std::string line;
+    while (std::getline(suite, line)) {
+        if (line.empty() || !MantaRay::Position::FromFen(line, position)) continue;
+
+        const uint8_t colorToMove = position.ColorToMove;
+        const size_t  count       = position.Features<MantaRay::InputLayout::Full>(white.data(), black.data());
+
+        Accumulate(floating .FeatureWeight, floating .FeatureBias, white.data(), count, hiddenSize, floatWhite);
+        Accumulate(floating .FeatureWeight, floating .FeatureBias, black.data(), count, hiddenSize, floatBlack);
+        Accumulate(quantized.FeatureWeight, quantized.FeatureBias, white.data(), count, hiddenSize, quantWhite);
+        Accumulate(quantized.FeatureWeight, quantized.FeatureBias, black.data(), count, hiddenSize, quantBlack);
+
+        const auto& floatUs   = colorToMove == 0 ? floatWhite : floatBlack;
+        const auto& floatThem = colorToMove == 0 ? floatBlack : floatWhite;
+        const auto& quantUs   = colorToMove == 0 ? quantWhite : quantBlack;
+        const auto& quantThem = colorToMove == 0 ? quantBlack : quantWhite;
+
+        // Count the activations clamped from above, which lose information, apart from the ReLU zero region:
+        for (size_t h = 0; h < hiddenSize; h++) {
+            saturated  += (quantUs  [h] >= QA) + (quantThem[h] >= QA);
+            zeroed     += (quantUs  [h] <= 0 ) + (quantThem[h] <= 0 );
+            overflowed += (quantUs  [h] != static_cast<int16_t>(quantUs  [h])) +
+                          (quantThem[h] != static_cast<int16_t>(quantThem[h]));
+        }
+
+        // Forward propagate both networks for every output head, mirroring PerspectiveNetwork::Evaluate for the
+        // quantized one:
+        for (size_t o = 0; o < outputSize; o++) {
+            const size_t stride = o * hiddenSize * 2;
+
+            double  floatSum = floating .OutputBias[o];
+            int32_t quantSum = quantized.OutputBias[o];
+            for (size_t h = 0; h < hiddenSize; h++) {
+                floatSum += std::clamp(floatUs  [h], 0.0, 1.0) * floating.OutputWeight[stride +              h];
+                floatSum += std::clamp(floatThem[h], 0.0, 1.0) * floating.OutputWeight[stride + hiddenSize + h];
+
+                quantSum += std::clamp(quantUs  [h], 0, static_cast<int32_t>(QA)) *
+                            quantized.OutputWeight[stride +              h];
+                quantSum += std::clamp(quantThem[h], 0, static_cast<int32_t>(QA)) *
+                            quantized.OutputWeight[stride + hiddenSize + h];
+            }
+
+            const double floatEval = floatSum * options.Scale;
+            const double quantEval = static_cast<int32_t>(quantSum * static_cast<int32_t>(options.Scale) /
+                                                          static_cast<int32_t>(QA * QB));
+
+            const double error = std::abs(floatEval - quantEval);
+            errorSum += error;
+            errorMax  = std::max(errorMax, error);
+        }
+
+        positions++;
+    }
+
+    std::cout << "Verification over " << positions << " positions:" << std::endl;
+    if (positions == 0) return;
+
+    const auto activations = static_cast<double>(positions * hiddenSize * 2);
+    std::cout << " | Mean absolute error  : " << errorSum / static_cast<double>(positions * outputSize) << std::endl;
+    std::cout << " | Max  absolute error  : " << errorMax << std::endl;
+    std::cout << " | Saturated activations: " << 100.0 * static_cast<double>(saturated) / activations << "%"
+              << std::endl;
+    std::cout << " | Zero activations     : " << 100.0 * static_cast<double>(zeroed   ) / activations << "%"
+              << std::endl;
+    std::cout << " | Int16 overflows      : " << overflowed << std::endl;
+}
+
+int main(const int argc, char** argv)
+{
+    ConverterOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    const size_t inputSize  = options.InputSize ;
+    const size_t hiddenSize = options.HiddenSize;
+    const size_t outputSize = options.OutputSize;
+
+    // Stream the trainer output into float arrays, permuting the feature weights into the binary layout:
+    FloatNetwork floating;
+    floating.FeatureWeight.resize(inputSize  * hiddenSize    );
+    floating.FeatureBias  .resize(hiddenSize                 );
+    floating.OutputWeight .resize(hiddenSize * 2 * outputSize);
+    floating.OutputBias   .resize(outputSize                 );
+
+    if (!(options.FloatInput ? ReadFloatBinary(options, floating) : ReadMarlinflow(options, floating))) {
+        std::cerr << "Failed to read " << options.Input << ": the file doesn't match the requested shape."
+                  << std::endl;
+        return 1;
+    }
+
+    // Quantize every tensor, keeping separate statistics for each:
+    QuantizedNetwork quantized;
+    MantaRay::Quantizer<int16_t> featureWeight(options.Rounding), featureBias(options.Rounding),
+                                 outputWeight (options.Rounding), outputBias (options.Rounding);
+
+    const double QA = options.QuantizationFeature;
+    const double QB = options.QuantizationOutput;
+    Quantize(featureWeight, floating.FeatureWeight, quantized.FeatureWeight, QA     );
+    Quantize(featureBias  , floating.FeatureBias  , quantized.FeatureBias  , QA     );
+    Quantize(outputWeight , floating.OutputWeight , quantized.OutputWeight , QB     );
+    Quantize(outputBias   , floating.OutputBias   , quantized.OutputBias   , QA * QB);
+
+    // Write the quantized network in the same order as PerspectiveNetwork::WriteTo:
+    MantaRay::BinaryFileStream output(options.Output);
+    output.WriteMode();
+    output.WriteArray(quantized.FeatureWeight.data(), quantized.FeatureWeight.size());
+    output.WriteArray(quantized.FeatureBias  .data(), quantized.FeatureBias  .size());
+    output.WriteArray(quantized.OutputWeight .data(), quantized.OutputWeight .size());
+    output.WriteArray(quantized.OutputBias   .data(), quantized.OutputBias   .size());
+
+    const auto stop = std::chrono::high_resolution_clock::now();
+
+    std::cout << "(" << inputSize << "->" << hiddenSize << ")x2->" << outputSize << " converted in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count() << "ms." << std::endl;
+    std::cout << "Quantization:" << std::endl;
+    Report("Input ->Hidden Weight", featureWeight);
+    Report("Hidden Bias          ", featureBias  );
+    Report("Hidden->Output Weight", outputWeight );
+    Report("Output Bias          ", outputBias   );
+
+    if (!options.Suite.empty()) Verify(options, floating, quantized);
+    return 0;
+}
@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_EVALUATIONCACHE_H
+#define MANTARAY_EVALUATIONCACHE_H
+
+#include <array>
+#include <atomic>
+#include <algorithm>
+#include <bit>
+#include <vector>
+#include <cstdint>
+#include <limits>
+
+#include "Memory/AlignedAllocator.h"
+
+namespace MantaRay
+{
+
+    /// \brief A lock-free cache of evaluations, keyed by position hash.
+    /// \details Every entry is a single 32-bit word holding a 16-bit fragment of the hash and the 16-bit evaluation,
+    ///          so an entry is always read and written as a whole with relaxed atomic accesses, and the cache can be
+    ///          shared by any number of search threads without locks. Entries are grouped in 64-byte buckets aligned
+    ///          to cache lines, and a hash always maps to a single entry of a single bucket, so a probe touches one
+    ///          cache line that can be prefetched ahead of time. Colliding positions simply replace each other.
+    class EvaluationCache
+    {
+
+        private:
+            constexpr static size_t EntriesPerBucket = 64 / sizeof(uint32_t);
+
+            struct alignas(64) Bucket
+            {
+                std::array<uint32_t, EntriesPerBucket> Entries {};
+            };
+
+            std::vector<Bucket, AlignedAllocator<Bucket>> Buckets;
+            size_t Mask = 0;
+
+            /// \brief The bucket a hash maps to.
+            [[nodiscard]] inline const Bucket& BucketOf(const uint64_t hash) const
+            {
+                return Buckets[hash & Mask];
+            }
+
+            /// \brief The entry within its bucket a hash maps to.
+            [[nodiscard]] inline static size_t EntryOf(const uint64_t hash)
+            {
+                return (hash >> 32) % EntriesPerBucket;
+            }
+
+            /// \brief The fragment of a hash stored in its entry.
+            /// \details The lowest bit is always set, so an empty entry never matches.
+            [[nodiscard]] inline static uint32_t FragmentOf(const uint64_t hash)
+            {
+                return (static_cast<uint32_t>(hash >> 48) | 1) << 16;
+            }
+
+        public:
+            /// \brief Constructs a new EvaluationCache.
+            /// \param megabytes The size of the cache, rounded down to a power of two number of buckets.
+            __attribute__((unused)) explicit EvaluationCache(const size_t megabytes)
+            {
+                Resize(megabytes);
+            }
+
+            /// \brief Resize the cache, clearing it.
+            /// \param megabytes The size of the cache, rounded down to a power of two number of buckets.
+            /// \details The cache must not be used by any thread while it is resized.
+            __attribute__((unused)) void Resize(const size_t megabytes)
+            {
+                const size_t buckets = std::bit_floor(std::max<size_t>(megabytes * 1024 * 1024 / sizeof(Bucket), 1));
+
+                Buckets = std::vector<Bucket, AlignedAllocator<Bucket>>(buckets);
+                Mask    = buckets - 1;
+            }
+
+            /// \brief Clear the cache.
+            /// \details The cache must be cleared when the network's weights change, unless the networks using it
+            ///          key their entries by weight identity, as MantaRay::PerspectiveNetwork does.
+            __attribute__((unused)) void Clear()
+            {
+                for (Bucket& bucket : Buckets)
+                    for (uint32_t& entry : bucket.Entries) std::atomic_ref(entry).store(0, std::memory_order_relaxed);
+            }
+
+            /// \brief Prefetch the cache line a hash maps to.
+            /// \param hash The hash of the position.
+            /// \details Call this as soon as the hash of a position is known, such as right after making a move, so
+            ///          the probe at evaluation time doesn't wait on memory.
+            __attribute__((unused)) inline void Prefetch(const uint64_t hash) const
+            {
+                __builtin_prefetch(&BucketOf(hash));
+            }
+
+            /// \brief Probe the cache for the evaluation of a position.
+            /// \param hash The hash of the position.
+            /// \param evaluation The cached evaluation, if the probe hits.
+            /// \return Whether the probe hit.
+            __attribute__((unused)) inline bool Probe(const uint64_t hash, int16_t& evaluation) const
+            {
+                // Entries are only ever accessed atomically, so reading through a const reference is safe:
+                uint32_t& slot = const_cast<uint32_t&>(BucketOf(hash).Entries[EntryOf(hash)]);
+                const uint32_t entry = std::atomic_ref(slot).load(std::memory_order_relaxed);
+
+                if ((entry & 0xFFFF0000) != FragmentOf(hash)) return false;
+
+                evaluation = static_cast<int16_t>(entry & 0xFFFF);
+                return true;
+            }
+
+            /// \brief Store the evaluation of a position.
+            /// \tparam OT The type of the evaluation.
+            /// \param hash The hash of the position.
+            /// \param evaluation The evaluation.
+            /// \details Evaluations that don't fit into 16 bits aren't stored.
+            template<typename OT>
+            __attribute__((unused)) inline void Store(const uint64_t hash, const OT evaluation)
+            {
+                if (evaluation < std::numeric_limits<int16_t>::min() ||
+                    evaluation > std::numeric_limits<int16_t>::max()) return;
+
+                const uint32_t entry = FragmentOf(hash) | static_cast<uint16_t>(evaluation);
+
+                uint32_t& slot = Buckets[hash & Mask].Entries[EntryOf(hash)];
+                std::atomic_ref(slot).store(entry, std::memory_order_relaxed);
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_EVALUATIONCACHE_H
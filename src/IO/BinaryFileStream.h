@@ -50,6 +50,20 @@ namespace MantaRay
                 this->Stream.read((char*)(&array), sizeof array);
             }
 
+            /// \brief Whether the file was opened and every read so far was satisfied by it.
+            /// \return False if the file is missing or ended before all arrays were read.
+            [[nodiscard]] __attribute__((unused)) bool Good() const
+            {
+                return this->Stream.is_open() && !this->Stream.fail();
+            }
+
+            /// \brief Whether every byte of the file was read.
+            /// \return False if the file holds more data than was read, such as a network of a larger shape.
+            [[nodiscard]] __attribute__((unused)) bool Finished()
+            {
+                return this->Stream.peek() == std::char_traits<char>::eof();
+            }
+
             /// \brief Write an array to the stream.
             /// \tparam T The type of the array.
             /// \tparam Size The size of the array.
@@ -61,6 +75,17 @@ namespace MantaRay
                 this->Stream.write((const char*)(&array), sizeof array);
             }
 
+            /// \brief Write a runtime-sized array to the stream.
+            /// \tparam T The type of the array.
+            /// \param array The array to write.
+            /// \param size The number of elements in the array.
+            /// \details This function writes an array whose size is only known at runtime to the stream.
+            template<typename T>
+            void WriteArray(const T* array, const size_t size)
+            {
+                this->Stream.write((const char*)(array), static_cast<std::streamsize>(size * sizeof(T)));
+            }
+
     };
 
 } // MantaRay
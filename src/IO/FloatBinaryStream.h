@@ -0,0 +1,160 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_FLOATBINARYSTREAM_H
+#define MANTARAY_FLOATBINARYSTREAM_H
+
+#include <array>
+#include <vector>
+#include <bit>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include "DataStream.h"
+#include "../SIMD.h"
+
+namespace MantaRay
+{
+
+    /// \brief A raw float32 tensor stream.
+    /// \details This class is used to read networks dumped by the trainer as consecutive little-endian float32
+    ///          tensors without any header. The shape of every tensor is declared by the reader. Integral destinations
+    ///          are quantized with SIMD while streaming, and 2D tensors can be permuted in the same pass, so no copy
+    ///          of the whole tensor is ever held in memory.
+    class FloatBinaryStream : DataStream<std::ios::binary | std::ios::in>
+    {
+
+        private:
+            // The number of rows gathered before a permuted 2D tensor is scattered into its destination. Gathering
+            // this many rows makes every scattered write cover a full cache line of 16-bit values.
+            constexpr static size_t PermutationBlock = 32;
+
+            std::vector<float> Buffer;
+
+            /// \brief Read consecutive floats from the stream into the buffer.
+            /// \param count The number of floats to read.
+            /// \return A pointer to the floats read.
+            const float* ReadFloats(const size_t count)
+            {
+                Buffer.resize(count);
+                this->Stream.read((char*)(Buffer.data()), static_cast<std::streamsize>(count * sizeof(float)));
+
+                // The tensors are stored in little-endian order, so swap the bytes on big-endian targets:
+                if constexpr (std::endian::native == std::endian::big)
+                    for (float& value : Buffer)
+                        value = std::bit_cast<float>(__builtin_bswap32(std::bit_cast<uint32_t>(value)));
+
+                return Buffer.data();
+            }
+
+            /// \brief Convert floats into the destination type.
+            /// \tparam T The destination type.
+            /// \param input The floats to convert.
+            /// \param output The destination.
+            /// \param size The number of floats.
+            /// \param K The Quantization factor.
+            /// \details Integral destinations are quantized, while floating-point destinations are only scaled. 16-bit
+            ///          destinations are quantized with SIMD, while wider ones (such as PSQT weights) are quantized
+            ///          one value at a time. Both truncate towards zero, as MantaRay::MarlinflowStream does, so that a
+            ///          network loads into the same weights from either format.
+            template<typename T>
+            static void Convert(const float* input, T* output, const size_t size, const float K)
+            {
+                if constexpr (std::is_floating_point_v<T>)
+                    for (size_t i = 0; i < size; i++) output[i] = static_cast<T>(input[i] * K);
+                else if constexpr (std::is_same_v<T, int16_t>) SIMD::Quantize(input, output, size, K);
+                else for (size_t i = 0; i < size; i++) output[i] = static_cast<T>(input[i] * K);
+            }
+
+        public:
+            /// \brief The constructor of the FloatBinaryStream.
+            /// \param path The path to the float32 tensor dump.
+            /// \details This constructor opens the file in binary read mode.
+            __attribute__((unused)) explicit FloatBinaryStream(const std::string& path) : DataStream(path) {}
+
+            /// \brief Read a 2D tensor from the stream.
+            /// \tparam T The type of the array.
+            /// \param array The array to read into.
+            /// \param rows The number of rows of the tensor.
+            /// \param columns The number of columns of the tensor.
+            /// \param K The Quantization factor.
+            /// \param permute Whether to permute the tensor.
+            /// \details This function reads a row-major 2D tensor from the stream, quantizing it and storing it in the
+            ///          provided array. If permuted, the tensor is stored column-major, which matches the permutation
+            ///          done by MantaRay::MarlinflowStream.
+            template<typename T>
+            void Read2DArray(T* array, const size_t rows, const size_t columns, const float K, const bool permute)
+            {
+                if (!permute) {
+                    // Rows are stored as they are, so stream them directly into the destination:
+                    for (size_t i = 0; i < rows; i++) Convert(ReadFloats(columns), array + i * columns, columns, K);
+                    return;
+                }
+
+                std::vector<T> block(PermutationBlock * columns);
+                for (size_t i = 0; i < rows; i += PermutationBlock) {
+                    const size_t count = std::min(PermutationBlock, rows - i);
+
+                    // Convert a block of rows at once:
+                    Convert(ReadFloats(count * columns), block.data(), count * columns, K);
+
+                    // Scatter the block, writing each column of the block contiguously:
+                    for (size_t j = 0; j < columns; j++)
+                        for (size_t r = 0; r < count; r++) array[j * rows + i + r] = block[r * columns + j];
+                }
+            }
+
+            /// \brief Read a 2D tensor from the stream.
+            /// \tparam T The type of the array.
+            /// \tparam Size The size of the array.
+            /// \param array The array to read into.
+            /// \param rows The number of rows of the tensor.
+            /// \param K The Quantization factor.
+            /// \param permute Whether to permute the tensor.
+            /// \details The number of columns is derived from the size of the array.
+            template<typename T, size_t Size>
+            void Read2DArray(std::array<T, Size>& array, const size_t rows, const float K, const bool permute)
+            {
+                assert(Size % rows == 0);
+
+                Read2DArray(array.data(), rows, Size / rows, K, permute);
+            }
+
+            /// \brief Read a 1D tensor from the stream.
+            /// \tparam T The type of the array.
+            /// \param array The array to read into.
+            /// \param size The size of the tensor.
+            /// \param K The Quantization factor.
+            /// \details This function reads a 1D tensor from the stream, quantizing it and storing it in the provided
+            ///          array.
+            template<typename T>
+            void ReadArray(T* array, const size_t size, const float K)
+            {
+                Convert(ReadFloats(size), array, size, K);
+            }
+
+            /// \brief Read a 1D tensor from the stream.
+            /// \tparam T The type of the array.
+            /// \tparam Size The size of the array.
+            /// \param array The array to read into.
+            /// \param K The Quantization factor.
+            template<typename T, size_t Size>
+            void ReadArray(std::array<T, Size>& array, const float K)
+            {
+                ReadArray(array.data(), Size, K);
+            }
+
+            /// \brief Whether every read so far was satisfied by the stream.
+            /// \return False if the stream ended before all tensors were read.
+            [[nodiscard]] __attribute__((unused)) bool Good() const
+            {
+                return !this->Stream.fail();
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_FLOATBINARYSTREAM_H
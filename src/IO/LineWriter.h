@@ -0,0 +1,94 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_LINEWRITER_H
+#define MANTARAY_LINEWRITER_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <cstddef>
+#include <utility>
+#include "DataStream.h"
+
+namespace MantaRay
+{
+
+    /// \brief A text stream written in chunks by any number of threads.
+    /// \details Chunks are numbered by their producer, such as the chunk index of MantaRay::MappedLineReader. An
+    ///          ordered writer buffers chunks that arrive early and writes every chunk in number order, while an
+    ///          unordered writer writes every chunk as soon as it arrives.
+    class LineWriter : DataStream<std::ios::out | std::ios::trunc>
+    {
+
+        private:
+            std::mutex Lock;
+
+            bool Ordered;
+
+            // The chunks that arrived before the chunk to be written next:
+            std::map<size_t, std::string> Early;
+            size_t NextIndex = 0;
+
+        public:
+            /// \brief Constructs a new LineWriter.
+            /// \param path The path to the text file, which is truncated.
+            /// \param ordered Whether chunks are written in number order.
+            __attribute__((unused)) LineWriter(const std::string& path, const bool ordered) :
+            DataStream(path), Ordered(ordered) {}
+
+            /// \brief Whether every write so far succeeded.
+            [[nodiscard]] __attribute__((unused)) bool Good() const
+            {
+                return !this->Stream.fail();
+            }
+
+            /// \brief Write a chunk.
+            /// \param index The number of the chunk, counting up from zero without gaps.
+            /// \param chunk The chunk.
+            /// \return The number of chunks written out by this call, which is zero if the chunk arrived early and
+            ///         is held back, and may include earlier chunks that were waiting on it.
+            /// \details This function may be called from any number of threads.
+            __attribute__((unused)) size_t Write(const size_t index, std::string&& chunk)
+            {
+                std::lock_guard<std::mutex> guard(Lock);
+
+                if (!Ordered) {
+                    this->Stream << chunk;
+                    return 1;
+                }
+
+                if (index != NextIndex) {
+                    Early.emplace(index, std::move(chunk));
+                    return 0;
+                }
+
+                this->Stream << chunk;
+                NextIndex++;
+
+                // Write the chunks that were waiting on this one:
+                size_t written = 1;
+                for (auto next = Early.find(NextIndex); next != Early.end(); next = Early.find(NextIndex)) {
+                    this->Stream << next->second;
+                    Early.erase(next);
+                    NextIndex++;
+                    written++;
+                }
+
+                return written;
+            }
+
+            /// \brief Flush the written chunks to the file.
+            __attribute__((unused)) void Flush()
+            {
+                std::lock_guard<std::mutex> guard(Lock);
+                this->Stream.flush();
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_LINEWRITER_H
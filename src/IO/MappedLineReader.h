@@ -0,0 +1,144 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_MAPPEDLINEREADER_H
+#define MANTARAY_MAPPEDLINEREADER_H
+
+#include <mutex>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstddef>
+#include <algorithm>
+#include <string_view>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace MantaRay
+{
+
+    /// \brief A reader handing out chunks of whole lines of a memory-mapped text file.
+    /// \details The file is mapped read-only and never copied: every chunk is a view into the mapping, ending at a
+    ///          line break, so chunks can be processed by different threads independently. Chunks are numbered in
+    ///          file order, which allows their results to be written back in order. On platforms without mmap, the
+    ///          file is read into memory instead.
+    class MappedLineReader
+    {
+
+        public:
+            /// \brief A chunk of whole lines.
+            struct Chunk
+            {
+                size_t           Index;
+                std::string_view Lines;
+            };
+
+        private:
+            std::mutex Lock;
+
+            const char* Data = nullptr;
+            size_t      Size = 0;
+
+            size_t Offset    = 0;
+            size_t NextIndex = 0;
+
+#ifdef __linux__
+            void* Mapping = nullptr;
+#endif
+            std::string Fallback;
+
+        public:
+            /// \brief Constructs a new MappedLineReader.
+            /// \param path The path to the text file.
+            /// \details Good() tells whether the file could be opened.
+            __attribute__((unused)) explicit MappedLineReader(const std::string& path)
+            {
+#ifdef __linux__
+                const int file = open(path.c_str(), O_RDONLY);
+                if (file < 0) return;
+
+                struct stat info {};
+                if (fstat(file, &info) == 0 && info.st_size > 0) {
+                    void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+                    if (mapping != MAP_FAILED) {
+                        // The file is read from front to back, so let the kernel read ahead aggressively:
+                        madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+
+                        Mapping = mapping;
+                        Data    = static_cast<const char*>(mapping);
+                        Size    = info.st_size;
+                    }
+                }
+
+                close(file);
+
+                // Empty files can't be mapped, but are valid nonetheless:
+                if (info.st_size == 0) Data = "";
+                if (Data != nullptr) return;
+#endif
+                std::ifstream stream(path, std::ios::binary);
+                if (!stream) return;
+
+                std::stringstream buffer;
+                buffer << stream.rdbuf();
+
+                Fallback = buffer.str();
+                Data     = Fallback.data();
+                Size     = Fallback.size();
+            }
+
+            MappedLineReader(const MappedLineReader&) = delete;
+            MappedLineReader& operator=(const MappedLineReader&) = delete;
+
+            ~MappedLineReader()
+            {
+#ifdef __linux__
+                if (Mapping != nullptr) munmap(Mapping, Size);
+#endif
+            }
+
+            /// \brief Whether the file could be opened.
+            [[nodiscard]] __attribute__((unused)) bool Good() const
+            {
+                return Data != nullptr;
+            }
+
+            /// \brief The size of the file in bytes.
+            [[nodiscard]] __attribute__((unused)) size_t Bytes() const
+            {
+                return Size;
+            }
+
+            /// \brief Take the next chunk of lines.
+            /// \param bytes The approximate size of the chunk, which is extended to the end of its last line.
+            /// \param chunk The chunk taken.
+            /// \return Whether a chunk was taken, false once the whole file was handed out.
+            /// \details This function may be called from any number of threads.
+            __attribute__((unused)) bool Next(const size_t bytes, Chunk& chunk)
+            {
+                std::lock_guard<std::mutex> guard(Lock);
+                if (Offset >= Size) return false;
+
+                // Extend the chunk to the end of the line it ends in:
+                const size_t target = std::min(Offset + std::max<size_t>(bytes, 1), Size);
+                const char* end = std::find(Data + target - 1, Data + Size, '\n');
+                const size_t stop = end == Data + Size ? Size : end - Data + 1;
+
+                chunk = { NextIndex++, std::string_view(Data + Offset, stop - Offset) };
+                Offset = stop;
+                return true;
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_MAPPEDLINEREADER_H
@@ -7,6 +7,7 @@
 #define MANTARAY_MARLINFLOWSTREAM_H
 
 #include <array>
+#include <vector>
 #include <cstdint>
 #include "DataStream.h"
 #include "../External/json.hpp"
@@ -15,25 +16,204 @@ namespace MantaRay
 {
 
     /// \brief A Marlinflow JSON stream.
-    /// \details This class is used to read Marlinflow JSON network data.
+    /// \details This class is used to read Marlinflow JSON network data. The file is never parsed into a JSON document:
+    ///          arrays are first bound to their keys, and a single streaming (SAX) pass over the file then quantizes,
+    ///          permutes and stores every number directly into its bound destination as it is encountered.
     class MarlinflowStream : DataStream<std::ios::in>
     {
 
         private:
             using JSON = nlohmann::json;
 
-            JSON data;
+            /// \brief A destination array bound to a key of the Marlinflow JSON file.
+            struct Binding
+            {
+
+                std::string Key;
+
+                void*  Array;
+                size_t Size;
+                size_t Stride;
+                size_t K;
+                bool   Permute;
+                bool   TwoDimensional;
+                bool   Required;
+
+                size_t Written = 0;
+
+                void (*Store)(void* array, size_t index, double value, size_t K);
+
+            };
+
+            /// \brief The SAX handler used to stream the Marlinflow JSON file into the bound arrays.
+            /// \details The handler tracks the object and array nesting of the file. Keys of the root object select
+            ///          the binding that subsequent numbers are stored into, while numbers of unbound keys are
+            ///          skipped without being stored anywhere.
+            class Handler
+            {
+
+                private:
+                    std::vector<Binding>& Bindings;
+
+                    Binding* Current = nullptr;
+
+                    size_t ObjectDepth = 0;
+                    size_t ArrayDepth  = 0;
+
+                    size_t Row    = 0;
+                    size_t Column = 0;
+
+                    /// \brief Store a number into the current binding.
+                    /// \param value The number to store.
+                    /// \return Whether the number fits into the current binding.
+                    bool Number(const double value)
+                    {
+                        // Skip numbers of keys that are not bound:
+                        if (Current == nullptr) return true;
+
+                        // Ensure the number sits at the depth expected from the binding:
+                        if (ArrayDepth != (Current->TwoDimensional ? 2 : 1)) return false;
+
+                        // Calculate the 1D index with respect to the stride and permutation (if necessary):
+                        size_t idx;
+                        if (Current->TwoDimensional) {
+                            // Refuse ragged or transposed tensors, whose inner index would spill into the next row:
+                            if ((Current->Permute ? Row : Column) >= Current->Stride) return false;
+
+                            idx = Current->Permute ? Column * Current->Stride + Row : Row * Current->Stride + Column;
+                        } else idx = Row;
+
+                        // Refuse to write past the end of the bound array:
+                        if (idx >= Current->Size) return false;
+
+                        // Quantize the value and store it in the array:
+                        Current->Store(Current->Array, idx, value, Current->K);
+                        Current->Written++;
+
+                        if (Current->TwoDimensional) Column++;
+                        else                         Row   ++;
+
+                        return true;
+                    }
+
+                public:
+                    using number_integer_t  = JSON::number_integer_t ;
+                    using number_unsigned_t = JSON::number_unsigned_t;
+                    using number_float_t    = JSON::number_float_t   ;
+                    using string_t          = JSON::string_t         ;
+                    using binary_t          = JSON::binary_t         ;
+
+                    explicit Handler(std::vector<Binding>& bindings) : Bindings(bindings) {}
+
+                    bool null() { return Current == nullptr; }
+
+                    bool boolean(bool) { return Current == nullptr; }
+
+                    bool number_integer(const number_integer_t value) { return Number(static_cast<double>(value)); }
+
+                    bool number_unsigned(const number_unsigned_t value) { return Number(static_cast<double>(value)); }
+
+                    bool number_float(const number_float_t value, const string_t&) { return Number(value); }
+
+                    bool string(string_t&) { return Current == nullptr; }
+
+                    bool binary(binary_t&) { return Current == nullptr; }
+
+                    bool start_object(size_t)
+                    {
+                        ObjectDepth++;
+                        return Current == nullptr;
+                    }
+
+                    bool end_object()
+                    {
+                        ObjectDepth--;
+                        return true;
+                    }
+
+                    bool key(string_t& key)
+                    {
+                        // Only keys of the root object select a binding:
+                        if (ObjectDepth != 1 || ArrayDepth != 0) return true;
+
+                        Current = nullptr;
+                        for (Binding& binding : Bindings) if (binding.Key == key) Current = &binding;
+
+                        Row    = 0;
+                        Column = 0;
+                        return true;
+                    }
+
+                    bool start_array(size_t)
+                    {
+                        ArrayDepth++;
+
+                        // Bound arrays may only be nested as deep as their dimensionality:
+                        return Current == nullptr || ArrayDepth <= (Current->TwoDimensional ? 2u : 1u);
+                    }
+
+                    bool end_array()
+                    {
+                        ArrayDepth--;
+
+                        // Step to the next row once the inner array of a 2D binding is closed:
+                        if (Current != nullptr && Current->TwoDimensional && ArrayDepth == 1) {
+                            Row++;
+                            Column = 0;
+                        }
+
+                        // The value of a bound key is complete once its outermost array is closed:
+                        if (ArrayDepth == 0) Current = nullptr;
+
+                        return true;
+                    }
+
+                    bool parse_error(size_t, const std::string&, const nlohmann::detail::exception&)
+                    {
+                        return false;
+                    }
+
+            };
+
+            std::vector<Binding> Bindings;
+
+            /// \brief Quantize a value and store it in an array.
+            /// \tparam T The type of the array.
+            /// \param array The array to store into.
+            /// \param index The index to store at.
+            /// \param value The value to quantize.
+            /// \param K The Quantization factor.
+            template<typename T>
+            static void Store(void* array, const size_t index, const double value, const size_t K)
+            {
+                static_cast<T*>(array)[index] = static_cast<T>(value * K);
+            }
 
         public:
             /// \brief The constructor of the MarlinflowStream.
             /// \param path The path to the Marlinflow JSON file.
-            /// \details This constructor will read the Marlinflow JSON file and parse it.
-            __attribute__((unused)) explicit MarlinflowStream(const std::string& path) : DataStream(path)
+            /// \details This constructor will open the Marlinflow JSON file. Nothing is parsed until Parse() is called.
+            __attribute__((unused)) explicit MarlinflowStream(const std::string& path) : DataStream(path) {}
+
+            /// \brief Bind a 2D array to a key of the Marlinflow JSON file.
+            /// \tparam T The type of the array.
+            /// \param key The key of the array.
+            /// \param array The array to read into.
+            /// \param size The size of the array.
+            /// \param stride The stride of the array.
+            /// \param K The Quantization factor.
+            /// \param permute Whether to permute the array.
+            /// \param required Whether the key must be present in the file.
+            /// \details The 2D array will be quantized, permuted if necessary, and stored in the provided array by the
+            ///          next call to Parse().
+            template<typename T>
+            void Bind2DArray(const std::string& key, T* array, const size_t size, const size_t stride,
+                             const size_t K, const bool permute, const bool required = true)
             {
-                data = JSON::parse(this->Stream);
+                Bindings.push_back({ key, array, size, stride, K, permute, true, required, 0, &Store<T> });
             }
 
-            /// \brief Read a 2D array from the Marlinflow JSON file.
+            /// \brief Bind a 2D array to a key of the Marlinflow JSON file.
             /// \tparam T The type of the array.
             /// \tparam Size The size of the array.
             /// \param key The key of the array.
@@ -41,54 +221,63 @@ namespace MantaRay
             /// \param stride The stride of the array.
             /// \param K The Quantization factor.
             /// \param permute Whether to permute the array.
-            /// \details This function will read a 2D array from the Marlinflow JSON file, quantize it and permute it if
-            ///          necessary, storing it in the provided array.
+            /// \param required Whether the key must be present in the file.
+            /// \details The 2D array will be quantized, permuted if necessary, and stored in the provided array by the
+            ///          next call to Parse().
             template<typename T, size_t Size>
-            void Read2DArray(const std::string& key, std::array<T, Size>& array, const size_t stride, const size_t K,
-                             const bool permute)
+            void Bind2DArray(const std::string& key, std::array<T, Size>& array, const size_t stride, const size_t K,
+                             const bool permute, const bool required = true)
             {
-                JSON &obj = data[key];
-
-                // Loop over the JSON object in a 2D fashion:
-                size_t i = 0;
-                for (auto &[k, v] : obj.items()) {
-                    size_t j = 0;
-
-                    for (auto &[k2, v2] : v.items()) {
-                        // Calculate the 1D index with respect to the stride and permutation (if necessary):
-                        size_t idx = permute ? j * stride + i : i * stride + j;
-
-                        // Quantize the value and store it in the array:
-                        auto d     = static_cast<double>(v2);
-                        array[idx] = static_cast<T>(d * K);
-                        j++;
-                    }
+                Bind2DArray(key, array.data(), Size, stride, K, permute, required);
+            }
 
-                    i++;
-                }
+            /// \brief Bind a 1D array to a key of the Marlinflow JSON file.
+            /// \tparam T The type of the array.
+            /// \param key The key of the array.
+            /// \param array The array to read into.
+            /// \param size The size of the array.
+            /// \param K The Quantization factor.
+            /// \param required Whether the key must be present in the file.
+            /// \details The 1D array will be quantized and stored in the provided array by the next call to Parse().
+            template<typename T>
+            void BindArray(const std::string& key, T* array, const size_t size, const size_t K,
+                           const bool required = true)
+            {
+                Bindings.push_back({ key, array, size, 0, K, false, false, required, 0, &Store<T> });
             }
 
-            /// \brief Read a 1D array from the Marlinflow JSON file.
+            /// \brief Bind a 1D array to a key of the Marlinflow JSON file.
             /// \tparam T The type of the array.
             /// \tparam Size The size of the array.
             /// \param key The key of the array.
             /// \param array The array to read into.
             /// \param K The Quantization factor.
-            /// \details This function will read a 1D array from the Marlinflow JSON file, quantize it and store it in
-            ///          the provided array.
+            /// \param required Whether the key must be present in the file.
+            /// \details The 1D array will be quantized and stored in the provided array by the next call to Parse().
             template<typename T, size_t Size>
-            void ReadArray(const std::string& key, std::array<T, Size>& array, const size_t K)
+            void BindArray(const std::string& key, std::array<T, Size>& array, const size_t K,
+                           const bool required = true)
             {
-                JSON &obj = data[key];
-
-                // Loop over the JSON object in a 1D fashion:
-                size_t i = 0;
-                for (auto &[k, v] : obj.items()) {
-                    // Quantize the value and store it in the array:
-                    auto d   = static_cast<double>(v);
-                    array[i] = static_cast<T>(d * K);
-                    i++;
-                }
+                BindArray(key, array.data(), Size, K, required);
+            }
+
+            /// \brief Parse the Marlinflow JSON file into the bound arrays.
+            /// \return Whether the file was parsed successfully and every bound array was completely filled, apart
+            ///         from optional arrays whose key is missing altogether.
+            /// \details This function streams the Marlinflow JSON file once, storing every number of a bound key
+            ///          directly in its array. Parsing stops at the first syntax error or at the first number that
+            ///          doesn't fit the shape of its bound array. The bindings are cleared afterwards.
+            bool Parse()
+            {
+                Handler handler(Bindings);
+                bool success = JSON::sax_parse(this->Stream, &handler);
+
+                // Ensure every bound array was filled completely:
+                for (const Binding& binding : Bindings)
+                    success &= binding.Written == binding.Size || (!binding.Required && binding.Written == 0);
+
+                Bindings.clear();
+                return success;
             }
 
     };
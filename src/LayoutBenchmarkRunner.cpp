@@ -0,0 +1,251 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#include "Perspective/PerspectiveNNUE.h"
+#include "Activation/ClippedReLU.h"
+
+#include <array>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <limits>
+#include <iomanip>
+#include <utility>
+#include <iostream>
+
+// Benchmarking tool comparing the accumulator layouts over a range of hidden sizes, on the compiled instruction set.
+
+template<uint16_t HiddenSize, MantaRay::AccumulatorLayout Layout>
+using Network = MantaRay::PerspectiveNetwork<int16_t, int32_t, MantaRay::ClippedReLU<int16_t, 0, 255>,
+                                             768, HiddenSize, 1, 1, 400, 255, 64, MantaRay::AlignedAllocator, 0,
+                                             MantaRay::InputLayout::Full, Layout>;
+
+struct LayoutBenchmarkOptions
+{
+
+    size_t Iterations = 1 << 18;
+
+    uint32_t Seed = 1;
+
+};
+
+struct LayoutTimings
+{
+
+    double Update   = 0;
+    double Capture  = 0;
+    double Refresh  = 0;
+    double Evaluate = 0;
+
+};
+
+void PrintUsage()
+{
+    std::cout << "Usage: MantaRayLayoutBenchmark [options]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --iterations <count>     Updates and evaluations timed (default 262144)."       << std::endl;
+    std::cout << "                           Refreshes are timed for a sixteenth of them."           << std::endl;
+    std::cout << "  --seed <seed>            Seed of the random weights and positions (default 1)." << std::endl;
+}
+
+bool ParseOptions(const int argc, char** argv, LayoutBenchmarkOptions& options)
+{
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+
+        // Every option takes exactly one value:
+        if (i + 1 >= argc) return false;
+        const std::string value = argv[++i];
+
+        if      (arg == "--iterations") options.Iterations = std::stoul(value);
+        else if (arg == "--seed"      ) options.Seed       = std::stoul(value);
+        else return false;
+    }
+
+    return options.Iterations > 0;
+}
+
+const char* InstructionSet()
+{
+#ifdef __AVX512BW__
+    return "AVX-512";
+#elifdef __AVX2__
+    return "AVX2";
+#else
+    return "Scalar";
+#endif
+}
+
+const char* LayoutName(const MantaRay::AccumulatorLayout layout)
+{
+    return layout == MantaRay::AccumulatorLayout::Split ? "Split" : "Interleaved";
+}
+
+std::vector<MantaRay::Position> RandomPositions(const size_t count, std::mt19937& rng)
+{
+    std::vector<MantaRay::Position> positions(count);
+    for (MantaRay::Position& position : positions) {
+        position.ColorToMove = rng() % 2;
+
+        // Place both kings and up to 30 other pieces on empty squares, keeping pawns off the back ranks:
+        const size_t pieces = 2 + rng() % 31;
+        for (size_t i = 0; i < pieces; i++) {
+            const uint8_t color = i % 2;
+            const uint8_t piece = i < 2 ? 5 : rng() % 5;
+
+            uint8_t sq;
+            do sq = piece == 0 ? 8 + rng() % 48 : rng() % 64;
+            while (position.Occupied() >> sq & 1);
+
+            position.Bitboards[color * 6 + piece] |= 1ULL << sq;
+        }
+    }
+
+    return positions;
+}
+
+template<typename Operation>
+double NanosecondsPerOperation(const size_t count, Operation operation)
+{
+    // Keep the fastest of a few repetitions, which filters out most of the noise of other processes:
+    double best = std::numeric_limits<double>::max();
+    for (size_t repetition = 0; repetition < 5; repetition++) {
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++) operation(i);
+        const auto stop  = std::chrono::steady_clock::now();
+
+        best = std::min(best, std::chrono::duration<double, std::nano>(stop - start).count());
+    }
+
+    return best / static_cast<double>(count);
+}
+
+template<uint16_t HiddenSize, MantaRay::AccumulatorLayout Layout>
+LayoutTimings Run(const LayoutBenchmarkOptions& options, const std::vector<MantaRay::Position>& positions,
+                  int64_t& checksum)
+{
+    using Net = Network<HiddenSize, Layout>;
+
+    // Both layouts of a hidden size draw the same weights and moves from the seed:
+    std::mt19937 rng(options.Seed);
+    std::uniform_int_distribution<int16_t> distribution(-64, 64);
+
+    const auto weights = std::make_shared<typename Net::Weights>();
+    for (int16_t& weight : weights->FeatureWeight) weight = distribution(rng);
+    for (int16_t& weight : weights->FeatureBias  ) weight = distribution(rng);
+    for (int16_t& weight : weights->OutputWeight ) weight = distribution(rng);
+    for (int16_t& weight : weights->OutputBias   ) weight = distribution(rng);
+
+    const Net network { std::shared_ptr<const typename Net::Weights>(weights) };
+
+    std::vector<std::pair<typename Net::Feature, typename Net::Feature>> moves(4096);
+    std::vector<typename Net::Feature> captures(moves.size());
+    for (size_t i = 0; i < moves.size(); i++) {
+        const uint8_t piece = rng() % 6;
+        const uint8_t color = rng() % 2;
+        const uint8_t to    = 8 + rng() % 48;
+
+        moves[i].first  = Net::FeatureOf(piece, color, 8 + rng() % 48);
+        moves[i].second = Net::FeatureOf(piece, color, to);
+
+        // The captured piece stands on the destination, and is never a king:
+        captures[i] = Net::FeatureOf(rng() % 5, color ^ 1, to);
+    }
+
+    std::vector<typename Net::Accumulator, MantaRay::AlignedAllocator<typename Net::Accumulator>> accumulators(64);
+    for (size_t i = 0; i < accumulators.size(); i++)
+        network.RefreshAccumulator(accumulators[i], positions[i % positions.size()]);
+
+    LayoutTimings timings;
+
+    // Update from parent to child, playing every move and then taking it back so the values stay bounded:
+    timings.Update = NanosecondsPerOperation(options.Iterations, [&](const size_t i) {
+        const auto& [from, to] = moves[i / 2 % moves.size()];
+        if (i % 2 == 0) network.EfficientlyUpdateAccumulator(accumulators[0], accumulators[1], from, to);
+        else            network.EfficientlyUpdateAccumulator(accumulators[1], accumulators[0], to, from);
+    });
+
+    // Capture from parent to child, removing the moved and the captured piece at once, and then take it back:
+    timings.Capture = NanosecondsPerOperation(options.Iterations, [&](const size_t i) {
+        const auto& [from, to] = moves[i / 2 % moves.size()];
+        const auto& captured   = captures[i / 2 % moves.size()];
+
+        if (i % 2 == 0)
+            network.EfficientlyUpdateAccumulator(accumulators[0], accumulators[1],
+                                                 std::array<typename Net::Feature, 2> { from, captured },
+                                                 std::array<typename Net::Feature, 1> { to });
+        else
+            network.EfficientlyUpdateAccumulator(accumulators[1], accumulators[0],
+                                                 std::array<typename Net::Feature, 1> { to },
+                                                 std::array<typename Net::Feature, 2> { from, captured });
+    });
+
+    timings.Refresh = NanosecondsPerOperation(std::max<size_t>(options.Iterations / 16, 1), [&](const size_t i) {
+        network.RefreshAccumulator(accumulators[i % accumulators.size()], positions[i % positions.size()]);
+    });
+
+    timings.Evaluate = NanosecondsPerOperation(options.Iterations, [&](const size_t i) {
+        checksum += network.Evaluate(accumulators[i % accumulators.size()], i % 2);
+    });
+
+    return timings;
+}
+
+template<uint16_t HiddenSize>
+void Compare(const LayoutBenchmarkOptions& options, const std::vector<MantaRay::Position>& positions,
+             int64_t& checksum)
+{
+    using MantaRay::AccumulatorLayout;
+
+    const std::array<LayoutTimings, 2> timings = {
+        Run<HiddenSize, AccumulatorLayout::Split      >(options, positions, checksum),
+        Run<HiddenSize, AccumulatorLayout::Interleaved>(options, positions, checksum)
+    };
+
+    for (uint8_t layout = 0; layout < 2; layout++)
+        std::cout << " | " << std::setw(6) << HiddenSize << " | " << std::setw(11) << std::left
+                  << LayoutName(static_cast<AccumulatorLayout>(layout)) << std::right
+                  << " | " << std::setw(9) << timings[layout].Update
+                  << " | " << std::setw(10) << timings[layout].Capture
+                  << " | " << std::setw(10) << timings[layout].Refresh
+                  << " | " << std::setw(11) << timings[layout].Evaluate << std::endl;
+
+    const auto faster = [](const double split, const double interleaved) {
+        return LayoutName(interleaved < split ? AccumulatorLayout::Interleaved : AccumulatorLayout::Split);
+    };
+
+    std::cout << " | " << std::setw(6) << HiddenSize << " | Faster: update " << faster(timings[0].Update,
+                                                                                        timings[1].Update)
+              << ", capture " << faster(timings[0].Capture , timings[1].Capture )
+              << ", refresh " << faster(timings[0].Refresh , timings[1].Refresh )
+              << ", evaluate " << faster(timings[0].Evaluate, timings[1].Evaluate) << std::endl;
+}
+
+int main(const int argc, char** argv)
+{
+    LayoutBenchmarkOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::mt19937 rng(options.Seed);
+    const std::vector<MantaRay::Position> positions = RandomPositions(1024, rng);
+
+    std::cout << "Accumulator layouts on " << InstructionSet() << ", " << options.Iterations << " iterations:"
+              << std::endl;
+    std::cout << " | Hidden | Layout      | Update ns | Capture ns | Refresh ns | Evaluate ns" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    int64_t checksum = 0;
+    Compare<256 >(options, positions, checksum);
+    Compare<512 >(options, positions, checksum);
+    Compare<1024>(options, positions, checksum);
+
+    // Print the evaluations so they can't be optimized out:
+    std::cout << "Checksum: " << checksum << std::endl;
+    return 0;
+}
@@ -0,0 +1,57 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_ALIGNEDALLOCATOR_H
+#define MANTARAY_ALIGNEDALLOCATOR_H
+
+#include <new>
+#include <cstddef>
+#include <algorithm>
+
+namespace MantaRay
+{
+
+    /// \brief An allocator returning memory aligned to cache lines.
+    /// \tparam T The type to allocate.
+    /// \details Every allocation is aligned to at least 64 bytes, which covers the widest SIMD register used by
+    ///          MantaRay and keeps allocations from sharing cache lines. This is the default allocation policy of
+    ///          the networks.
+    template<typename T>
+    class AlignedAllocator
+    {
+
+        public:
+            using value_type = T;
+
+            constexpr static std::size_t Alignment = std::max<std::size_t>(64, alignof(T));
+
+            AlignedAllocator() noexcept = default;
+
+            template<typename U>
+            AlignedAllocator(const AlignedAllocator<U>&) noexcept {} // NOLINT(google-explicit-constructor)
+
+            /// \brief Allocate aligned memory.
+            /// \param count The number of elements to allocate.
+            /// \return The allocated memory.
+            [[nodiscard]] T* allocate(const std::size_t count)
+            {
+                return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+            }
+
+            /// \brief Free memory allocated by this allocator.
+            /// \param pointer The memory to free.
+            void deallocate(T* pointer, std::size_t) noexcept
+            {
+                ::operator delete(pointer, std::align_val_t(Alignment));
+            }
+
+            template<typename U>
+            bool operator==(const AlignedAllocator<U>&) const noexcept { return true; }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_ALIGNEDALLOCATOR_H
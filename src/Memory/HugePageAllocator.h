@@ -0,0 +1,145 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_HUGEPAGEALLOCATOR_H
+#define MANTARAY_HUGEPAGEALLOCATOR_H
+
+#include <new>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include "AlignedAllocator.h"
+
+namespace MantaRay
+{
+
+    /// \brief An allocator backing its memory with 2 MB huge pages.
+    /// \tparam T The type to allocate.
+    /// \tparam Lock Whether to lock the memory into RAM.
+    /// \details Randomly accessing rows of a multi-megabyte weight matrix misses the TLB constantly when the matrix
+    ///          is backed by regular 4 KB pages. This allocator first asks for explicit huge pages (MAP_HUGETLB),
+    ///          which requires huge pages to be reserved by the system. If none are available, it maps regular pages
+    ///          aligned to 2 MB and advises the kernel to back them with transparent huge pages. If requested, the
+    ///          memory is also locked with mlock so it can never be swapped out; failing to lock is not an error.
+    ///          Allocations smaller than half a huge page, such as per-thread scratch vectors, would waste most of
+    ///          the page they are rounded up to, so they fall back to MantaRay::AlignedAllocator, as do all
+    ///          allocations on other platforms.
+    ///
+    ///          Networks take a single-parameter allocation policy, so use MantaRay::HugePageAllocator or
+    ///          MantaRay::LockedHugePageAllocator rather than this class directly.
+    template<typename T, bool Lock>
+    class BasicHugePageAllocator
+    {
+
+        private:
+            constexpr static std::size_t HugePageSize = 2 * 1024 * 1024;
+
+            // Allocations smaller than this are served by the aligned allocator:
+            constexpr static std::size_t MinimumSize = HugePageSize / 2;
+
+            /// \brief Round the size of an allocation up to whole huge pages.
+            static constexpr std::size_t RoundUp(const std::size_t size)
+            {
+                return (size + HugePageSize - 1) / HugePageSize * HugePageSize;
+            }
+
+        public:
+            using value_type = T;
+
+            template<typename U>
+            struct rebind
+            {
+
+                using other = BasicHugePageAllocator<U, Lock>;
+
+            };
+
+            BasicHugePageAllocator() noexcept = default;
+
+            template<typename U>
+            // NOLINTNEXTLINE(google-explicit-constructor)
+            BasicHugePageAllocator(const BasicHugePageAllocator<U, Lock>&) noexcept {}
+
+            /// \brief Allocate memory backed by huge pages.
+            /// \param count The number of elements to allocate.
+            /// \return The allocated memory.
+            [[nodiscard]] T* allocate(const std::size_t count)
+            {
+#ifdef __linux__
+                if (count * sizeof(T) < MinimumSize) return AlignedAllocator<T>().allocate(count);
+
+                const std::size_t size = RoundUp(count * sizeof(T));
+
+                // Try explicit huge pages first:
+                void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+                if (memory == MAP_FAILED) {
+                    // Map an extra huge page so the region can be trimmed to a huge page boundary:
+                    auto* region = static_cast<uint8_t*>(mmap(nullptr, size + HugePageSize, PROT_READ | PROT_WRITE,
+                                                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+                    if (region == MAP_FAILED) throw std::bad_alloc();
+
+                    const auto address = reinterpret_cast<uintptr_t>(region);
+                    auto* aligned = reinterpret_cast<uint8_t*>(RoundUp(address));
+
+                    // Unmap the unaligned head and the unused tail of the region:
+                    const std::size_t head = aligned - region;
+                    if (head > 0) munmap(region, head);
+                    munmap(aligned + size, HugePageSize - head);
+
+                    // Ask for the aligned memory to be backed by transparent huge pages:
+                    madvise(aligned, size, MADV_HUGEPAGE);
+                    memory = aligned;
+                }
+
+                if constexpr (Lock) mlock(memory, size);
+
+                return static_cast<T*>(memory);
+#else
+                return AlignedAllocator<T>().allocate(count);
+#endif
+            }
+
+            /// \brief Free memory allocated by this allocator.
+            /// \param pointer The memory to free.
+            /// \param count The number of elements that were allocated.
+            void deallocate(T* pointer, const std::size_t count) noexcept
+            {
+#ifdef __linux__
+                if (count * sizeof(T) < MinimumSize) return AlignedAllocator<T>().deallocate(pointer, count);
+
+                const std::size_t size = RoundUp(count * sizeof(T));
+
+                if constexpr (Lock) munlock(pointer, size);
+                munmap(pointer, size);
+#else
+                AlignedAllocator<T>().deallocate(pointer, count);
+#endif
+            }
+
+            template<typename U>
+            bool operator==(const BasicHugePageAllocator<U, Lock>&) const noexcept { return true; }
+
+    };
+
+    /// \brief An allocator backing its memory with 2 MB huge pages.
+    /// \tparam T The type to allocate.
+    /// \see MantaRay::BasicHugePageAllocator for the details.
+    template<typename T>
+    using HugePageAllocator = BasicHugePageAllocator<T, false>;
+
+    /// \brief An allocator backing its memory with 2 MB huge pages locked into RAM.
+    /// \tparam T The type to allocate.
+    template<typename T>
+    using LockedHugePageAllocator = BasicHugePageAllocator<T, true>;
+
+} // MantaRay
+
+#endif //MANTARAY_HUGEPAGEALLOCATOR_H
@@ -0,0 +1,98 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_NUMAREPLICATEDWEIGHTS_H
+#define MANTARAY_NUMAREPLICATEDWEIGHTS_H
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "NumaTopology.h"
+#include "AlignedAllocator.h"
+
+namespace MantaRay
+{
+
+    /// \brief Read-only weights replicated once per NUMA node.
+    /// \tparam Weights The weight type.
+    /// \tparam Allocator The allocation policy for the replicas, such as MantaRay::HugePageAllocator.
+    /// \details On multi-socket machines, threads reading weights that live on a remote node pay for every access
+    ///          with interconnect latency. This class copies the weights once per node, with every copy made by a
+    ///          thread bound to its node so the kernel places the pages of the copy on that node on first touch.
+    ///          Search threads should bind themselves to a node, and then construct their network (and thus their
+    ///          accumulator stack) from the replica of that node, keeping all of their data node-local. On a single
+    ///          node machine, the original weights are shared without copying.
+    template<typename Weights, template<typename> typename Allocator = AlignedAllocator>
+    class NumaReplicatedWeights
+    {
+
+        private:
+            NumaTopology Topology;
+
+            std::vector<std::shared_ptr<const Weights>> Replicas;
+
+        public:
+            /// \brief Constructs new NumaReplicatedWeights.
+            /// \param weights The weights to replicate.
+            /// \param topology The NUMA topology to replicate the weights over.
+            __attribute__((unused)) explicit NumaReplicatedWeights(const std::shared_ptr<const Weights>& weights,
+                                                                   NumaTopology topology = NumaTopology::Discover()) :
+            Topology(std::move(topology)), Replicas(Topology.Nodes())
+            {
+                if (Topology.Nodes() == 1) {
+                    Replicas[0] = weights;
+                    return;
+                }
+
+                // Copy the weights on a thread bound to each node, so the copy is first touched on its node:
+                std::vector<std::thread> threads;
+                for (size_t node = 0; node < Topology.Nodes(); node++)
+                    threads.emplace_back([this, &weights, node] {
+                        Topology.BindCurrentThread(node);
+                        Replicas[node] = std::allocate_shared<Weights>(Allocator<Weights>(), *weights);
+                    });
+
+                for (std::thread& thread : threads) thread.join();
+            }
+
+            /// \brief The NUMA topology the weights are replicated over.
+            [[nodiscard]] __attribute__((unused)) const NumaTopology& Nodes() const
+            {
+                return Topology;
+            }
+
+            /// \brief The replica of a node.
+            /// \param node The node.
+            /// \return The weights local to the node.
+            [[nodiscard]] __attribute__((unused)) const std::shared_ptr<const Weights>& ForNode(const size_t node) const
+            {
+                return Replicas[node];
+            }
+
+            /// \brief The replica of the node the calling thread runs on.
+            /// \return The weights local to the calling thread.
+            [[nodiscard]] __attribute__((unused)) const std::shared_ptr<const Weights>& ForCurrentThread() const
+            {
+                return Replicas[Topology.CurrentNode()];
+            }
+
+            /// \brief Bind the calling search thread to its node and get the replica of that node.
+            /// \param thread The index of the search thread.
+            /// \return The weights local to the node the thread was bound to.
+            /// \details Networks constructed by the thread afterwards allocate their accumulator stacks node-locally.
+            __attribute__((unused)) const std::shared_ptr<const Weights>& BindSearchThread(const size_t thread) const
+            {
+                const size_t node = Topology.NodeForThread(thread);
+                Topology.BindCurrentThread(node);
+
+                return Replicas[node];
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_NUMAREPLICATEDWEIGHTS_H
@@ -0,0 +1,185 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_NUMATOPOLOGY_H
+#define MANTARAY_NUMATOPOLOGY_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstddef>
+#include <algorithm>
+#include <utility>
+
+#ifdef __linux__
+#include <sched.h>
+#include <pthread.h>
+#endif
+
+namespace MantaRay
+{
+
+    /// \brief The NUMA nodes of the machine and the CPUs belonging to them.
+    /// \details The topology is discovered from /sys/devices/system/node, so no NUMA library is required. Machines
+    ///          (or platforms) without that directory are treated as a single node spanning every CPU, in which case
+    ///          binding threads is a no-op.
+    class NumaTopology
+    {
+
+        private:
+            std::vector<std::vector<size_t>> NodeCpus;
+
+            /// \brief Parse a kernel CPU or node list, such as "0-3,8-11".
+            /// \param list The list.
+            /// \return The CPUs or nodes in the list.
+            static std::vector<size_t> ParseList(const std::string& list)
+            {
+                std::vector<size_t> cpus;
+
+                std::stringstream ss(list);
+                std::string range;
+                while (std::getline(ss, range, ',')) {
+                    if (range.empty() || range == "\n") continue;
+
+                    const size_t dash  = range.find('-');
+                    const size_t first = std::stoul(range.substr(0, dash));
+                    const size_t last  = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+
+                    for (size_t cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+                }
+
+                return cpus;
+            }
+
+            /// \brief Read the first line of a kernel file.
+            /// \param path The path to the file.
+            /// \param line The line read.
+            /// \return Whether the file exists.
+            static bool ReadLine(const std::string& path, std::string& line)
+            {
+                std::ifstream file(path);
+                if (!file) return false;
+
+                std::getline(file, line);
+                return true;
+            }
+
+        public:
+            /// \brief Discover the NUMA topology of the machine.
+            /// \return The discovered topology.
+            /// \details The online nodes are read from the kernel's node list, as their IDs may have gaps. Nodes
+            ///          without CPUs can't run a thread and nodes without memory can't hold a replica, so both are
+            ///          skipped, and the nodes of the topology are numbered densely from zero.
+            __attribute__((unused)) static NumaTopology Discover()
+            {
+                NumaTopology topology;
+
+                const std::string root = "/sys/devices/system/node/";
+
+                std::string online;
+                if (ReadLine(root + "online", online)) {
+                    // Older kernels don't list the nodes with memory, in which case every node is assumed to have some:
+                    std::string memory;
+                    const bool known = ReadLine(root + "has_memory", memory);
+                    const std::vector<size_t> withMemory = ParseList(memory);
+
+                    for (const size_t node : ParseList(online)) {
+                        if (known && std::find(withMemory.begin(), withMemory.end(), node) == withMemory.end())
+                            continue;
+
+                        std::string list;
+                        if (!ReadLine(root + "node" + std::to_string(node) + "/cpulist", list)) continue;
+
+                        std::vector<size_t> cpus = ParseList(list);
+                        if (!cpus.empty()) topology.NodeCpus.push_back(std::move(cpus));
+                    }
+                }
+
+                // Fall back to a single node if the topology isn't exposed:
+                if (topology.NodeCpus.empty()) topology.NodeCpus.emplace_back();
+
+                return topology;
+            }
+
+            /// \brief The number of NUMA nodes.
+            [[nodiscard]] __attribute__((unused)) size_t Nodes() const
+            {
+                return NodeCpus.size();
+            }
+
+            /// \brief The CPUs belonging to a node.
+            /// \param node The node.
+            /// \return The CPUs of the node, which is empty if the topology isn't known.
+            [[nodiscard]] __attribute__((unused)) const std::vector<size_t>& Cpus(const size_t node) const
+            {
+                return NodeCpus[node];
+            }
+
+            /// \brief The node a search thread should run on.
+            /// \param thread The index of the search thread.
+            /// \return The node, spreading threads evenly over the nodes in proportion to their CPU count.
+            [[nodiscard]] __attribute__((unused)) size_t NodeForThread(const size_t thread) const
+            {
+                size_t total = 0;
+                for (const auto& cpus : NodeCpus) total += cpus.size();
+                if (total == 0) return thread % NodeCpus.size();
+
+                // Walk the nodes as if threads were handed out CPU by CPU:
+                size_t index = thread % total;
+                for (size_t node = 0; node < NodeCpus.size(); node++) {
+                    if (index < NodeCpus[node].size()) return node;
+                    index -= NodeCpus[node].size();
+                }
+
+                return 0;
+            }
+
+            /// \brief The node the calling thread is currently running on.
+            /// \return The node, or zero if it can't be determined.
+            [[nodiscard]] __attribute__((unused)) size_t CurrentNode() const
+            {
+#ifdef __linux__
+                const int cpu = sched_getcpu();
+                if (cpu < 0) return 0;
+
+                for (size_t node = 0; node < NodeCpus.size(); node++)
+                    if (std::find(NodeCpus[node].begin(), NodeCpus[node].end(), static_cast<size_t>(cpu)) !=
+                        NodeCpus[node].end()) return node;
+#endif
+
+                return 0;
+            }
+
+            /// \brief Bind the calling thread to the CPUs of a node.
+            /// \param node The node to bind to.
+            /// \return Whether the thread was bound.
+            /// \details Memory first touched by the thread afterwards is allocated on the node by the kernel.
+            __attribute__((unused)) bool BindCurrentThread(const size_t node) const
+            {
+#ifdef __linux__
+                const std::vector<size_t>& cpus = NodeCpus[node];
+                if (cpus.empty()) return false;
+
+                const size_t count = *std::max_element(cpus.begin(), cpus.end()) + 1;
+                cpu_set_t* set  = CPU_ALLOC(count);
+                const size_t size = CPU_ALLOC_SIZE(count);
+
+                CPU_ZERO_S(size, set);
+                for (const size_t cpu : cpus) CPU_SET_S(cpu, size, set);
+
+                const bool bound = pthread_setaffinity_np(pthread_self(), size, set) == 0;
+                CPU_FREE(set);
+                return bound;
+#else
+                return false;
+#endif
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_NUMATOPOLOGY_H
@@ -0,0 +1,334 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_DELTAACCUMULATORSTACK_H
+#define MANTARAY_DELTAACCUMULATORSTACK_H
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
+
+#include "../AccumulatorOperation.h"
+#include "../Memory/AlignedAllocator.h"
+
+namespace MantaRay
+{
+
+    /// \brief A delta-compressed accumulator stack.
+    /// \tparam Network The network whose accumulators are stacked, such as MantaRay::PerspectiveNetwork.
+    /// \tparam SnapshotInterval The number of plies between full snapshots of the accumulator.
+    /// \tparam MaxDeltasPerPly The maximum number of updates made within a single ply.
+    /// \tparam Allocator The allocation policy for the snapshots, such as MantaRay::HugePageAllocator.
+    /// \details A regular accumulator stack stores a full accumulator for every ply, which adds up to megabytes per
+    ///          thread for large hidden layers and deep searches. This stack only materializes the accumulator of
+    ///          the current ply, takes a full snapshot when entering every SnapshotInterval-th ply, and records
+    ///          the few feature updates made in every other ply. Leaving a snapshot ply restores the snapshot, while
+    ///          leaving any other ply reverts the updates recorded for it. Integer accumulators wrap around, so
+    ///          reverting is exact; float accumulators would drift, so only integer networks are supported.
+    ///
+    ///          A move never needs more than four updates (castling with a rook counts as two moves, and a capturing
+    ///          promotion as a removal, a deactivation and an activation), which is the default MaxDeltasPerPly.
+    ///          Updates made in snapshot plies aren't recorded, as the snapshot restores the accumulator instead. A
+    ///          ply that makes more updates than it can record, or refreshes the accumulator, spills: the
+    ///          accumulator it was entered with is copied aside once and restored when the ply is left, just like
+    ///          a snapshot. Spilled plies are left in the reverse order they spilled in, so their accumulators are
+    ///          kept on a stack that only grows to the number of plies spilled at once.
+    template<typename Network, uint16_t SnapshotInterval = 8, uint8_t MaxDeltasPerPly = 4,
+            template<typename> typename Allocator = AlignedAllocator>
+    class DeltaAccumulatorStack
+    {
+
+        static_assert(SnapshotInterval > 0, "The snapshot interval must at least be greater than zero.");
+        static_assert(MaxDeltasPerPly  > 0, "A ply must at least allow a single update.");
+
+        // Deltas only record piece-square features, so threat features would never be applied nor reverted:
+        static_assert(Network::Threats == 0, "Networks with threat features can't be stacked by deltas.");
+
+        public:
+            using Accumulator = typename Network::Accumulator;
+
+        private:
+            // Reverting an update only restores the accumulator exactly if its values wrap around:
+            static_assert(std::is_integral_v<typename decltype(Accumulator::Values)::value_type>,
+                          "Only integer accumulators can be reverted exactly.");
+
+        private:
+            using OutputType = decltype(std::declval<const Network&>().Evaluate(std::declval<const Accumulator&>(),
+                                                                                0));
+
+            /// \brief The kind of update recorded.
+            enum class DeltaKind : uint8_t
+            {
+                Activate,
+                Deactivate,
+                Move
+            };
+
+            /// \brief A single feature update, recorded so it can be reverted.
+            struct Delta
+            {
+                DeltaKind Kind;
+                uint8_t   Piece;
+                uint8_t   Color;
+                uint8_t   From;
+                uint8_t   To;
+            };
+
+            /// \brief The updates made within a single ply.
+            struct PlyDeltas
+            {
+                std::array<Delta, MaxDeltasPerPly> Deltas;
+                uint8_t Count = 0;
+
+                // Whether the accumulator the ply was entered with was copied aside, instead of being recorded:
+                bool Spilled = false;
+
+                // The index of the spilled accumulator on the spill stack:
+                size_t SpillIndex = 0;
+            };
+
+            const Network* Net;
+
+            // The accumulator of the current ply, which is always up to date:
+            Accumulator Current;
+
+            std::vector<Accumulator, Allocator<Accumulator>> Snapshots;
+            std::vector<PlyDeltas> Plies;
+
+            // The accumulators spilled plies were entered with, the deepest spilled ply last. The stack only grows
+            // when more plies are spilled at once than ever before:
+            std::vector<Accumulator, Allocator<Accumulator>> Spills;
+            size_t SpillCount = 0;
+
+            size_t CurrentPly = 0;
+
+            // The index of the guard ply past the end of the usable stack, which absorbs pushes that overflow:
+            size_t GuardPly;
+            bool Overflow = false;
+
+            /// \brief Revert an update made to an accumulator.
+            /// \param accumulator The accumulator.
+            /// \param delta The update.
+            inline void Revert(Accumulator& accumulator, const Delta& delta) const
+            {
+                switch (delta.Kind) {
+                    case DeltaKind::Activate:
+                        Net->template EfficientlyUpdateAccumulator<AccumulatorOperation::Deactivate>(
+                                accumulator, delta.Piece, delta.Color, delta.To);
+                        break;
+                    case DeltaKind::Deactivate:
+                        Net->template EfficientlyUpdateAccumulator<AccumulatorOperation::Activate>(
+                                accumulator, delta.Piece, delta.Color, delta.To);
+                        break;
+                    case DeltaKind::Move:
+                        Net->EfficientlyUpdateAccumulator(accumulator, delta.Piece, delta.Color, delta.To, delta.From);
+                        break;
+                }
+            }
+
+            /// \brief Copy the accumulator the current ply was entered with aside, so leaving the ply restores it.
+            /// \details The accumulator is recovered by reverting the updates recorded so far on a copy of the current
+            ///          accumulator, after which the ply no longer records updates.
+            inline void Spill()
+            {
+                PlyDeltas& ply = Plies[CurrentPly];
+                if (ply.Spilled) return;
+
+                if (SpillCount == Spills.size()) Spills.emplace_back();
+                ply.SpillIndex = SpillCount++;
+
+                Accumulator& spill = Spills[ply.SpillIndex];
+                Current.CopyTo(spill);
+
+                for (size_t i = ply.Count; i-- > 0;) Revert(spill, ply.Deltas[i]);
+
+                ply.Count   = 0;
+                ply.Spilled = true;
+            }
+
+            /// \brief Record an update made in the current ply.
+            /// \param delta The update, which was already made to the current accumulator.
+            /// \details A ply that has no room left for the update spills instead.
+            inline void Record(const Delta delta)
+            {
+                PlyDeltas& ply = Plies[CurrentPly];
+                if (ply.Spilled) return;
+
+                if (ply.Count < MaxDeltasPerPly) {
+                    ply.Deltas[ply.Count++] = delta;
+                    return;
+                }
+
+                // The update was already made, so it is reverted from the spilled accumulator as well. Integer updates
+                // commute, so the order they are reverted in doesn't matter:
+                Spill();
+                Revert(Spills[ply.SpillIndex], delta);
+            }
+
+        public:
+            /// \brief Constructs a new DeltaAccumulatorStack.
+            /// \param network The network to update and evaluate the accumulators with, which must outlive the stack.
+            /// \param stackSize The size of the stack, such as the maximum search depth.
+            __attribute__((unused)) explicit DeltaAccumulatorStack(const Network& network, const size_t stackSize) :
+            Net(&network), Snapshots(stackSize / SnapshotInterval + 1), Plies(stackSize + 1), GuardPly(stackSize)
+            {
+                assert(stackSize > 0);
+            }
+
+            /// \brief The accumulator of the current ply.
+            [[nodiscard]] __attribute__((unused)) inline const Accumulator& Top() const
+            {
+                return Current;
+            }
+
+            /// \brief The current ply.
+            [[nodiscard]] __attribute__((unused)) inline size_t Ply() const
+            {
+                return CurrentPly;
+            }
+
+            /// \brief Whether the stack overflowed since it was last reset.
+            /// \return True if a push went past the end of the stack, after which pulls are no longer valid.
+            [[nodiscard]] __attribute__((unused)) inline bool Overflowed() const
+            {
+                return Overflow;
+            }
+
+            /// \brief Reset the stack to the root.
+            /// \details This function resets the ply counter to zero, and clears the overflow flag.
+            __attribute__((unused)) inline void ResetAccumulator()
+            {
+                CurrentPly = 0;
+                SpillCount = 0;
+                Overflow = false;
+            }
+
+            /// \brief Refreshes the current accumulator.
+            /// \details This function refreshes the current accumulator with the bias, after which the pieces of the
+            ///          position must be activated again. Outside of snapshot plies (such as the root), the ply spills
+            ///          first, as the refresh can't be reverted.
+            __attribute__((unused)) inline void RefreshAccumulator()
+            {
+                if (CurrentPly % SnapshotInterval != 0) Spill();
+
+                Net->RefreshAccumulator(Current);
+            }
+
+            /// \brief Pushes a new ply onto the stack.
+            /// \details The accumulator of the new ply starts out as the accumulator of the previous ply. A full
+            ///          snapshot is only taken when entering a snapshot ply; otherwise, pushing is free.
+            __attribute__((unused)) inline void PushAccumulator()
+            {
+                const size_t next = CurrentPly + 1;
+
+                // Clamp the push to the guard ply and remember if it was hit:
+                Overflow |= next >= GuardPly;
+                CurrentPly = std::min(next, GuardPly);
+
+                // Snapshot the accumulator the snapshot ply is entered with:
+                if (CurrentPly % SnapshotInterval == 0) Current.CopyTo(Snapshots[CurrentPly / SnapshotInterval]);
+
+                // Pushing past the guard ply re-enters it, dropping its spill, which is the deepest one:
+                PlyDeltas& ply = Plies[CurrentPly];
+                if (next > GuardPly && ply.Spilled) SpillCount = ply.SpillIndex;
+
+                ply.Count   = 0;
+                ply.Spilled = false;
+            }
+
+            /// \brief Pulls the current ply from the stack.
+            /// \details This function restores the accumulator of the previous ply, from the snapshot or spill of the
+            ///          ply being left if it has one, or by reverting the updates of the ply being left otherwise.
+            __attribute__((unused)) inline void PullAccumulator()
+            {
+                assert(CurrentPly > 0);
+
+                const PlyDeltas& ply = Plies[CurrentPly];
+
+                if (CurrentPly % SnapshotInterval == 0) Snapshots[CurrentPly / SnapshotInterval].CopyTo(Current);
+                else if (ply.Spilled) {
+                    assert(ply.SpillIndex + 1 == SpillCount);
+
+                    Spills[ply.SpillIndex].CopyTo(Current);
+                    SpillCount--;
+                }
+                else {
+                    // Revert the updates in reverse order:
+                    for (size_t i = ply.Count; i-- > 0;) Revert(Current, ply.Deltas[i]);
+                }
+
+                CurrentPly--;
+            }
+
+            /// \brief Efficiently updates the current accumulator with a new piece move.
+            /// \param piece The piece that is moved.
+            /// \param color The color of the piece that is moved.
+            /// \param from The square the piece is moved from.
+            /// \param to The square the piece is moved to.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
+            __attribute__((unused)) inline void EfficientlyUpdateAccumulator(const uint8_t piece, const uint8_t color,
+                                                                             const uint8_t from, const uint8_t to)
+            {
+                Net->EfficientlyUpdateAccumulator(Current, piece, color, from, to);
+
+                if (CurrentPly % SnapshotInterval != 0) Record({DeltaKind::Move, piece, color, from, to});
+            }
+
+            /// \brief Efficiently updates the current accumulator with a new piece insertion or removal.
+            /// \tparam Operation The operation to perform on the accumulator.
+            /// \param piece The piece that is inserted or removed.
+            /// \param color The color of the piece that is inserted or removed.
+            /// \param sq The square the piece is inserted or removed from.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
+            template<AccumulatorOperation Operation>
+            __attribute__((unused)) inline void EfficientlyUpdateAccumulator(const uint8_t piece, const uint8_t color,
+                                                                             const uint8_t sq)
+            {
+                Net->template EfficientlyUpdateAccumulator<Operation>(Current, piece, color, sq);
+
+                constexpr DeltaKind Kind = Operation == AccumulatorOperation::Activate ? DeltaKind::Activate :
+                                                                                         DeltaKind::Deactivate;
+
+                // Snapshot plies are restored rather than reverted, so their updates aren't recorded:
+                if (CurrentPly % SnapshotInterval != 0) Record({Kind, piece, color, sq, sq});
+            }
+
+            /// \brief Evaluates the network with respect to the current accumulator.
+            /// \param colorToMove The color to move.
+            /// \return The evaluation of the network.
+            [[nodiscard]] __attribute__((unused)) inline OutputType Evaluate(const uint8_t colorToMove) const
+            {
+                return Net->Evaluate(Current, colorToMove);
+            }
+
+            /// \brief Evaluates the network with respect to the current accumulator, through the network's cache.
+            /// \param colorToMove The color to move.
+            /// \param hash The hash of the position, which must account for the color to move.
+            /// \return The evaluation of the network.
+            [[nodiscard]] __attribute__((unused)) inline OutputType Evaluate(const uint8_t colorToMove,
+                                                                             const uint64_t hash) const
+            {
+                return Net->Evaluate(Current, colorToMove, hash);
+            }
+
+            /// \brief Evaluates the PSQT (linear) term of the current accumulator.
+            /// \param colorToMove The color to move.
+            /// \param bucket The PSQT output to evaluate.
+            /// \return The linear term of the network.
+            [[nodiscard]] __attribute__((unused)) inline OutputType QuickEvaluate(const uint8_t colorToMove,
+                                                                                  const uint8_t bucket = 0) const
+            {
+                return Net->QuickEvaluate(Current, colorToMove, bucket);
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_DELTAACCUMULATORSTACK_H
@@ -0,0 +1,306 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_DUALNETWORK_H
+#define MANTARAY_DUALNETWORK_H
+
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include "Position.h"
+#include "../AccumulatorOperation.h"
+#include "../Memory/AlignedAllocator.h"
+
+namespace MantaRay
+{
+
+    /// \brief The network of a MantaRay::DualPerspectiveNetwork to evaluate.
+    enum class DualHead : uint8_t
+    {
+        Small,
+        Large
+    };
+
+    /// \brief A combined evaluator of a small, fast network and a large, accurate network.
+    /// \tparam SmallNetwork The small network, such as MantaRay::PerspectiveNetwork.
+    /// \tparam LargeNetwork The large network, such as MantaRay::PerspectiveNetwork.
+    /// \tparam Allocator The allocation policy for the accumulator stacks, such as MantaRay::HugePageAllocator.
+    /// \details Both networks must share an input layout. The evaluator keeps one accumulator stack per network in
+    ///          lockstep behind a single update API: the feature indices of every update are computed once and
+    ///          applied to both networks, and pushing a ply is deferred until the first update made in it, so the
+    ///          child accumulators of both networks are written from their parents in a single fused pass. The
+    ///          caller picks which network to evaluate at every node, such as the small network for lopsided
+    ///          positions and the large network otherwise.
+    template<typename SmallNetwork, typename LargeNetwork, template<typename> typename Allocator = AlignedAllocator>
+    class DualPerspectiveNetwork
+    {
+
+        static_assert(SmallNetwork::Inputs == LargeNetwork::Inputs, "Both networks must share an input layout.");
+
+        // Updates only carry piece-square features, so threat features would never be applied:
+        static_assert(SmallNetwork::Threats == 0 && LargeNetwork::Threats == 0,
+                      "Networks with threat features can't be paired.");
+
+        public:
+            using SmallAccumulator = typename SmallNetwork::Accumulator;
+            using LargeAccumulator = typename LargeNetwork::Accumulator;
+
+        private:
+            using SmallOutput = decltype(std::declval<const SmallNetwork&>().Evaluate(
+                    std::declval<const SmallAccumulator&>(), 0));
+            using LargeOutput = decltype(std::declval<const LargeNetwork&>().Evaluate(
+                    std::declval<const LargeAccumulator&>(), 0));
+
+            using OutputType = std::common_type_t<SmallOutput, LargeOutput>;
+
+            const SmallNetwork* Small;
+            const LargeNetwork* Large;
+
+            std::vector<SmallAccumulator, Allocator<SmallAccumulator>> SmallAccumulators;
+            std::vector<LargeAccumulator, Allocator<LargeAccumulator>> LargeAccumulators;
+
+            size_t CurrentAccumulator = 0;
+
+            // The index of the guard slot past the end of the usable stack, which absorbs pushes that overflow:
+            size_t GuardAccumulator;
+            bool Overflow = false;
+
+            // Whether the current accumulators were pushed but not yet written from their parents:
+            bool Fresh = false;
+
+            /// \brief Write the current accumulators from their parents if they were pushed but not yet updated.
+            inline void Materialize()
+            {
+                if (!Fresh) return;
+
+                SmallAccumulators[CurrentAccumulator - 1].CopyTo(SmallAccumulators[CurrentAccumulator]);
+                LargeAccumulators[CurrentAccumulator - 1].CopyTo(LargeAccumulators[CurrentAccumulator]);
+                Fresh = false;
+            }
+
+            /// \brief The accumulators an update reads from.
+            /// \details The parent accumulators while the current ply is fresh, so the update also performs the push.
+            [[nodiscard]] inline size_t Source() const
+            {
+                return CurrentAccumulator - Fresh;
+            }
+
+        public:
+            /// \brief Constructs a new DualPerspectiveNetwork.
+            /// \param small The small network, which must outlive the evaluator.
+            /// \param large The large network, which must outlive the evaluator.
+            /// \param stackSize The size of the accumulator stacks, such as the maximum search depth.
+            __attribute__((unused)) DualPerspectiveNetwork(const SmallNetwork& small, const LargeNetwork& large,
+                                                           const size_t stackSize) :
+            Small(&small), Large(&large), SmallAccumulators(stackSize + 1), LargeAccumulators(stackSize + 1),
+            GuardAccumulator(stackSize)
+            {
+                assert(stackSize > 0);
+            }
+
+            /// \brief The small network.
+            [[nodiscard]] __attribute__((unused)) inline const SmallNetwork& SmallNet() const
+            {
+                return *Small;
+            }
+
+            /// \brief The large network.
+            [[nodiscard]] __attribute__((unused)) inline const LargeNetwork& LargeNet() const
+            {
+                return *Large;
+            }
+
+            /// \brief Whether the stacks overflowed since they were last reset.
+            /// \return True if a push went past the end of the stacks, after which pulls are no longer valid.
+            [[nodiscard]] __attribute__((unused)) inline bool Overflowed() const
+            {
+                return Overflow;
+            }
+
+            /// \brief Reset the stacks to the root.
+            /// \details This function resets the accumulator pointer to zero, and clears the overflow flag.
+            __attribute__((unused)) inline void ResetAccumulator()
+            {
+                CurrentAccumulator = 0;
+                Overflow = false;
+                Fresh = false;
+            }
+
+            /// \brief Refreshes the current accumulators of both networks.
+            /// \details This function refreshes the current accumulators with the biases, after which the pieces of
+            ///          the position must be activated again.
+            __attribute__((unused)) inline void RefreshAccumulator()
+            {
+                Small->RefreshAccumulator(SmallAccumulators[CurrentAccumulator]);
+                Large->RefreshAccumulator(LargeAccumulators[CurrentAccumulator]);
+                Fresh = false;
+            }
+
+            /// \brief Refreshes the current accumulators of both networks from a position.
+            /// \param position The position.
+            __attribute__((unused)) inline void RefreshAccumulator(const Position& position)
+            {
+                Small->RefreshAccumulator(SmallAccumulators[CurrentAccumulator], position);
+                Large->RefreshAccumulator(LargeAccumulators[CurrentAccumulator], position);
+                Fresh = false;
+            }
+
+            /// \brief Pushes a new ply onto both stacks.
+            /// \details The push is deferred until the first update made in the new ply, which writes the new
+            ///          accumulators from their parents directly. A ply without updates is copied on demand.
+            __attribute__((unused)) inline void PushAccumulator()
+            {
+                Materialize();
+
+                const size_t next = CurrentAccumulator + 1;
+
+                // Clamp the push to the guard slot and remember if it was hit:
+                Overflow |= next >= GuardAccumulator;
+                CurrentAccumulator = std::min(next, GuardAccumulator);
+
+                // At the guard slot, the parent is the slot itself, so there is nothing to defer:
+                Fresh = next <= GuardAccumulator;
+            }
+
+            /// \brief Pulls the current ply from both stacks.
+            __attribute__((unused)) inline void PullAccumulator()
+            {
+                assert(CurrentAccumulator > 0);
+
+                CurrentAccumulator--;
+                Fresh = false;
+            }
+
+            /// \brief Prefetch the weights both networks read for a piece move.
+            /// \param piece The piece that is moved.
+            /// \param color The color of the piece that is moved.
+            /// \param from The square the piece is moved from.
+            /// \param to The square the piece is moved to.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
+            __attribute__((unused)) inline void PrefetchUpdate(const uint8_t piece, const uint8_t color,
+                                                               const uint8_t from, const uint8_t to) const
+            {
+                Small->PrefetchUpdate(piece, color, from, to);
+                Large->PrefetchUpdate(piece, color, from, to);
+            }
+
+            /// \brief Prefetch the weights both networks read for a piece insertion or removal.
+            /// \param piece The piece that is inserted or removed.
+            /// \param color The color of the piece that is inserted or removed.
+            /// \param sq The square the piece is inserted or removed from.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
+            __attribute__((unused)) inline void PrefetchUpdate(const uint8_t piece, const uint8_t color,
+                                                               const uint8_t sq) const
+            {
+                Small->PrefetchUpdate(piece, color, sq);
+                Large->PrefetchUpdate(piece, color, sq);
+            }
+
+            /// \brief Efficiently updates the current accumulators of both networks with a new piece move.
+            /// \param piece The piece that is moved.
+            /// \param color The color of the piece that is moved.
+            /// \param from The square the piece is moved from.
+            /// \param to The square the piece is moved to.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
+            __attribute__((unused)) inline void EfficientlyUpdateAccumulator(const uint8_t piece, const uint8_t color,
+                                                                             const uint8_t from, const uint8_t to)
+            {
+                // Compute the features once for both networks:
+                const auto featureFrom = SmallNetwork::FeatureOf(piece, color, from);
+                const auto featureTo   = SmallNetwork::FeatureOf(piece, color, to  );
+
+                const size_t source = Source();
+
+                Small->EfficientlyUpdateAccumulator(SmallAccumulators[source],
+                                                    SmallAccumulators[CurrentAccumulator],
+                                                    {featureFrom.White, featureFrom.Black},
+                                                    {featureTo  .White, featureTo  .Black});
+                Large->EfficientlyUpdateAccumulator(LargeAccumulators[source],
+                                                    LargeAccumulators[CurrentAccumulator],
+                                                    {featureFrom.White, featureFrom.Black},
+                                                    {featureTo  .White, featureTo  .Black});
+
+                Fresh = false;
+            }
+
+            /// \brief Efficiently updates the current accumulators of both networks with a new piece insertion or
+            ///        removal.
+            /// \tparam Operation The operation to perform on the accumulators.
+            /// \param piece The piece that is inserted or removed.
+            /// \param color The color of the piece that is inserted or removed.
+            /// \param sq The square the piece is inserted or removed from.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
+            template<AccumulatorOperation Operation>
+            __attribute__((unused)) inline void EfficientlyUpdateAccumulator(const uint8_t piece, const uint8_t color,
+                                                                             const uint8_t sq)
+            {
+                // Compute the feature once for both networks:
+                const auto feature = SmallNetwork::FeatureOf(piece, color, sq);
+
+                const size_t source = Source();
+
+                Small->template EfficientlyUpdateAccumulator<Operation>(SmallAccumulators[source],
+                                                                        SmallAccumulators[CurrentAccumulator],
+                                                                        {feature.White, feature.Black});
+                Large->template EfficientlyUpdateAccumulator<Operation>(LargeAccumulators[source],
+                                                                        LargeAccumulators[CurrentAccumulator],
+                                                                        {feature.White, feature.Black});
+
+                Fresh = false;
+            }
+
+            /// \brief Evaluates one of the networks with respect to its current accumulator.
+            /// \tparam Head The network to evaluate.
+            /// \param colorToMove The color to move.
+            /// \return The evaluation of the network.
+            template<DualHead Head>
+            [[nodiscard]] __attribute__((unused)) inline auto Evaluate(const uint8_t colorToMove)
+            {
+                Materialize();
+
+                if constexpr (Head == DualHead::Small)
+                    return Small->Evaluate(SmallAccumulators[CurrentAccumulator], colorToMove);
+                else
+                    return Large->Evaluate(LargeAccumulators[CurrentAccumulator], colorToMove);
+            }
+
+            /// \brief Evaluates one of the networks with respect to its current accumulator.
+            /// \param head The network to evaluate.
+            /// \param colorToMove The color to move.
+            /// \return The evaluation of the network.
+            [[nodiscard]] __attribute__((unused)) inline OutputType Evaluate(const DualHead head,
+                                                                             const uint8_t colorToMove)
+            {
+                if (head == DualHead::Small) return Evaluate<DualHead::Small>(colorToMove);
+                return Evaluate<DualHead::Large>(colorToMove);
+            }
+
+            /// \brief Evaluates one of the networks with respect to its current accumulator, through its cache.
+            /// \param head The network to evaluate.
+            /// \param colorToMove The color to move.
+            /// \param hash The hash of the position, which must account for the color to move.
+            /// \return The evaluation of the network.
+            /// \details Each network evaluates through the cache attached to it. Both networks may share one cache, as
+            ///          entries are keyed by the identity of their weights as well.
+            [[nodiscard]] __attribute__((unused)) inline OutputType Evaluate(const DualHead head,
+                                                                             const uint8_t colorToMove,
+                                                                             const uint64_t hash)
+            {
+                Materialize();
+
+                if (head == DualHead::Small)
+                    return Small->Evaluate(SmallAccumulators[CurrentAccumulator], colorToMove, hash);
+                return Large->Evaluate(LargeAccumulators[CurrentAccumulator], colorToMove, hash);
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_DUALNETWORK_H
@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_INPUTLAYOUT_H
+#define MANTARAY_INPUTLAYOUT_H
+
+#include <array>
+#include <cstdint>
+
+namespace MantaRay
+{
+
+    /// \brief The layout of the rows of the feature weights.
+    enum class InputLayout : uint8_t
+    {
+        /// \brief A row for every color, piece and square (768 rows).
+        Full,
+        /// \brief The full layout without the rows of pawns on the first and last ranks, which can never occur
+        ///        (736 rows).
+        Compact
+    };
+
+    /// \brief The feature rows of an input layout.
+    /// \tparam Layout The input layout.
+    /// \details The pieces are ordered pawn, knight, bishop, rook, queen and king, and the squares from A1 to H8,
+    ///          which matches the Marlinflow input layout.
+    template<InputLayout Layout>
+    class InputFeatures
+    {
+
+        public:
+            /// \brief The row of features that can never occur.
+            constexpr static uint16_t Dead = UINT16_MAX;
+
+            /// \brief The number of rows of the layout.
+            constexpr static uint16_t Count = Layout == InputLayout::Full ? 768 : 768 - 2 * 16;
+
+            using Table = std::array<std::array<std::array<uint16_t, 64>, 6>, 2>;
+
+        private:
+            /// \brief Build the row of every color, piece and square.
+            constexpr static Table Build()
+            {
+                Table table {};
+
+                uint16_t row = 0;
+                for (auto& color : table)
+                    for (uint8_t piece = 0; piece < 6; piece++)
+                        for (uint8_t sq = 0; sq < 64; sq++) {
+                            // Pawns never stand on the first or last rank:
+                            const bool dead = Layout == InputLayout::Compact && piece == 0 && (sq < 8 || sq >= 56);
+
+                            color[piece][sq] = dead ? Dead : row++;
+                        }
+
+                return table;
+            }
+
+        public:
+            /// \brief The row of every color, piece and square, indexed in that order.
+            constexpr static Table Index = Build();
+
+            static_assert(Index[1][5][63] == Count - 1, "The rows of the layout must be dense.");
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_INPUTLAYOUT_H
@@ -7,6 +7,10 @@
 #define MANTARAY_PERSPECTIVEACCUMULATOR_H
 
 #include <array>
+#include <cstdint>
+#include <algorithm>
+
+#include "../AccumulatorLayout.h"
 
 #ifdef __AVX512BW__
 #include "../Backend/Avx512.h"
@@ -20,27 +24,29 @@ namespace MantaRay
     /// \brief The Perspective-accounting Accumulator.
     /// \tparam T The internal type of the accumulator.
     /// \tparam AccumulatorSize The size of the accumulator.
+    /// \tparam PsqtBuckets The number of PSQT (linear) outputs accumulated alongside the activations.
+    /// \tparam Layout The memory layout of the two perspectives.
     /// \details The accumulator is used to store the input layer activations of the Perspective-accounting
     ///          Neural Network and allow efficient updates to the activations (other activations / deactivations).
-    ///          The accumulator is internally aligned to architecture-specific boundaries to allow for efficient
-    ///          SIMD operations.
+    ///          The activations of both perspectives share a single array, placed according to the layout. The
+    ///          accumulator is internally aligned to cache lines to allow for efficient SIMD operations.
     /// \see MantaRay::AccumulatorOperation for the operations that can be performed on the accumulator.
+    /// \see MantaRay::AccumulatorLayout for the layouts of the perspectives.
     /// \see MantaRay::PerspectiveNNUE for the Neural Network implementation that uses this accumulator.
-    template<typename T, size_t AccumulatorSize>
+    template<typename T, size_t AccumulatorSize, size_t PsqtBuckets = 0,
+             AccumulatorLayout Layout = AccumulatorLayout::Split>
     class PerspectiveAccumulator
     {
 
         public:
-#ifdef __AVX512BW__
-            alignas(64) std::array<T, AccumulatorSize> White;
-            alignas(64) std::array<T, AccumulatorSize> Black;
-#elifdef __AVX2__
-            alignas(32) std::array<T, AccumulatorSize> White;
-            alignas(32) std::array<T, AccumulatorSize> Black;
-#else
-            std::array<T, AccumulatorSize> White;
-            std::array<T, AccumulatorSize> Black;
-#endif
+            using Storage = PerspectiveStorage<Layout, T, AccumulatorSize>;
+
+            /// \brief The activations of both perspectives.
+            /// \see MantaRay::PerspectiveStorage::Index for the placement of the activations.
+            alignas(64) std::array<T, AccumulatorSize * 2> Values;
+
+            std::array<int32_t, PsqtBuckets> WhitePsqt;
+            std::array<int32_t, PsqtBuckets> BlackPsqt;
 
             /// \brief Default constructor.
             /// \details Initializes the accumulator to zero.
@@ -49,82 +55,73 @@ namespace MantaRay
                 Zero();
             }
 
+            /// \brief An activation of a perspective.
+            /// \param perspective The perspective, zero for white and one for black.
+            /// \param i The index of the activation within the perspective.
+            /// \return The activation.
+            [[nodiscard]] __attribute__((unused)) inline T Value(const uint8_t perspective, const size_t i) const
+            {
+                return Values[Storage::Index(perspective, i)];
+            }
+
             /// \brief Copy method for the accumulator.
             /// \param accumulator The accumulator to copy to.
             /// \details Copies the contents of this accumulator to the provided accumulator. Uses SIMD instructions
-            ///          where beneficial.
-            inline void CopyTo(PerspectiveAccumulator<T, AccumulatorSize>& accumulator)
+            ///          where beneficial. Both layouts are copied as a single contiguous array.
+            inline void CopyTo(PerspectiveAccumulator<T, AccumulatorSize, PsqtBuckets, Layout>& accumulator) const
             {
                 // Certain instructions can be limited further down, but due to alignment issues, performance may not be
                 // best. Thus, currently limiting to peak instruction set.
-
 #ifdef __AVX512BW__ // Limit this to AVX512F instead.
                 // Define the register:
-                Vec512I zmm0;
+                Vec512<T> zmm0;
 
-                // Define the step size for the loops:
+                // Define the step size for the loop:
                 constexpr size_t Step = sizeof(Vec512I) / sizeof(T);
 
-                //region White
-                for (size_t i = 0; i < AccumulatorSize; i += Step) {
-                    // Load the accumulator values into the register:
-                    zmm0 = Avx512<T>::From(White, i);
-
-                    // Store the register values into the target accumulator:
-                    Avx512<T>::Store(zmm0, accumulator.White, i);
-                }
-                //endregion
-
-                //region Black
-                for (size_t i = 0; i < AccumulatorSize; i += Step) {
+                for (size_t i = 0; i < AccumulatorSize * 2; i += Step) {
                     // Load the accumulator values into the register:
-                    zmm0 = Avx512<T>::From(Black, i);
+                    zmm0 = Avx512<T>::From(Values, i);
 
                     // Store the register values into the target accumulator:
-                    Avx512<T>::Store(zmm0, accumulator.Black, i);
+                    Avx512<T>::Store(zmm0, accumulator.Values, i);
                 }
-                //endregion
 #elifdef __AVX2__ // Limit this to AVX instead.
                 // Define the register:
-                Vec256I ymm0;
+                Vec256<T> ymm0;
 
-                // Define the step size for the loops:
+                // Define the step size for the loop:
                 constexpr size_t Step = sizeof(Vec256I) / sizeof(T);
 
-                //region White
-                for (size_t i = 0; i < AccumulatorSize; i += Step) {
-                    // Load the accumulator values into the register:
-                    ymm0 = Avx<T>::From(White, i);
-
-                    // Store the register values into the target accumulator:
-                    Avx<T>::Store(ymm0, accumulator.White, i);
-                }
-                //endregion
-
-                //region Black
-                for (size_t i = 0; i < AccumulatorSize; i += Step) {
+                for (size_t i = 0; i < AccumulatorSize * 2; i += Step) {
                     // Load the accumulator values into the register:
-                    ymm0 = Avx<T>::From(Black, i);
+                    ymm0 = Avx<T>::From(Values, i);
 
                     // Store the register values into the target accumulator:
-                    Avx<T>::Store(ymm0, accumulator.Black, i);
+                    Avx<T>::Store(ymm0, accumulator.Values, i);
                 }
-                //endregion
 #else
-                std::copy(std::begin(White), std::end(White), std::begin(accumulator.White));
-                std::copy(std::begin(Black), std::end(Black), std::begin(accumulator.Black));
+                std::copy(std::begin(Values), std::end(Values), std::begin(accumulator.Values));
 #endif
+
+                accumulator.WhitePsqt = WhitePsqt;
+                accumulator.BlackPsqt = BlackPsqt;
             }
 
             /// \brief Loads the bias into the accumulator.
             /// \param bias The bias to load.
             /// \details This method is used to load the bias into the accumulator. This is once at the start to
             ///          properly initialize the accumulator, and prevents having to load the bias every time the
-            ///          accumulator is updated or inferred from.
-            inline void LoadBias(std::array<T, AccumulatorSize>& bias)
+            ///          accumulator is updated or inferred from. The PSQT outputs have no bias, so they are zeroed.
+            inline void LoadBias(const std::array<T, AccumulatorSize>& bias)
             {
-                std::copy(std::begin(bias), std::end(bias), std::begin(White));
-                std::copy(std::begin(bias), std::end(bias), std::begin(Black));
+                // Copy the bias in the runs that are contiguous in storage:
+                for (uint8_t perspective = 0; perspective < 2; perspective++)
+                    for (size_t i = 0; i < AccumulatorSize; i += Storage::Run)
+                        std::copy_n(bias.begin() + i, Storage::Run, Values.begin() + Storage::Index(perspective, i));
+
+                WhitePsqt.fill(0);
+                BlackPsqt.fill(0);
             }
 
             /// \brief Zeroes out the accumulator.
@@ -132,8 +129,10 @@ namespace MantaRay
             ///          potential issues with uninitialized or unchecked memory.
             inline void Zero()
             {
-                std::fill(std::begin(White), std::end(White), 0);
-                std::fill(std::begin(Black), std::end(Black), 0);
+                std::fill(std::begin(Values), std::end(Values), 0);
+
+                WhitePsqt.fill(0);
+                BlackPsqt.fill(0);
             }
 
     };
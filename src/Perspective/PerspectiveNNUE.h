@@ -10,43 +10,75 @@
 #include <cstdint>
 #include <cassert>
 #include <sstream>
+#include <memory>
+#include <vector>
+#include <span>
+#include <algorithm>
 
 #include "PerspectiveAccumulator.h"
+#include "PerspectiveWeights.h"
+#include "InputLayout.h"
+#include "Position.h"
 #include "../SIMD.h"
+#include "../Activation/Softmax.h"
+#include "../WeightHandle.h"
+#include "../EvaluationCache.h"
+#include "../Memory/AlignedAllocator.h"
+#include "../Memory/HugePageAllocator.h"
 #include "../AccumulatorOperation.h"
-#include "../IO/BinaryFileStream.h"
-#include "../IO/BinaryMemoryStream.h"
-#include "../IO/MarlinflowStream.h"
 
 namespace MantaRay
 {
 
     /// \brief A Perspective-accounting Neural Network.
-    /// \tparam T The internal input layer type of the network. Currently only int16_t is supported.
-    /// \tparam OT The internal output layer type of the network. Currently only int32_t is supported.
+    /// \tparam T The internal input layer type of the network, either int16_t for a quantized network or float for
+    ///           an unquantized reference network.
+    /// \tparam OT The internal output layer type of the network, int32_t for a quantized network or float otherwise.
     /// \tparam Activation The activation function to use.
     /// \tparam InputSize The size of the input layer.
     /// \tparam HiddenSize The size of the hidden layer.
     /// \tparam OutputSize The size of the output layer.
-    /// \tparam AccumulatorStackSize The size of the accumulator stack.
+    /// \tparam AccumulatorStackSize The default size of the accumulator stack, used unless a size is given at
+    ///                              construction.
     /// \tparam Scale The scale factor of the network.
-    /// \tparam QuantizationFeature The quantization factor of the input layer.
-    /// \tparam QuantizationOutput The quantization factor of the output layer.
+    /// \tparam QuantizationFeature The quantization factor of the input layer, ignored by float networks.
+    /// \tparam QuantizationOutput The quantization factor of the output layer, ignored by float networks.
+    /// \tparam Allocator The allocation policy for the weights and the accumulator stack, such as
+    ///                   MantaRay::AlignedAllocator or MantaRay::HugePageAllocator.
+    /// \tparam PsqtBuckets The number of PSQT (linear) outputs accumulated alongside the hidden layer, or zero to
+    ///                     disable them.
+    /// \tparam Layout The layout of the rows of the feature weights, such as MantaRay::InputLayout::Compact to
+    ///                drop the rows of features that can never occur.
+    /// \tparam Storage The memory layout of the perspectives of the accumulators, such as
+    ///                 MantaRay::AccumulatorLayout::Interleaved to walk both perspectives in a single stream.
+    /// \tparam ThreatInputs The number of sparse threat features (such as attacked and defended piece-square pairs)
+    ///                      accumulated on top of the piece-square features through a weight matrix of their own, or
+    ///                      zero to disable them.
     /// \details This class implements a perspective-accounting neural network. It is a feed-forward network with
     ///          one hidden layer.
     ///
     ///          The architecture is as follows: Concat((InputLayer -> Activation -> HiddenLayer)x2, CTM) -> OutputLayer
     ///          where CTM is the Color To Move.
+    ///
+    ///          All storage of the network lives on the heap, so the network is small enough to live on a thread
+    ///          stack and cheap to move.
     template<typename T, typename OT, typename Activation,
             uint16_t InputSize, uint16_t HiddenSize, uint16_t OutputSize,
-            uint16_t AccumulatorStackSize, T Scale, T QuantizationFeature, T QuantizationOutput>
+            uint16_t AccumulatorStackSize, T Scale, T QuantizationFeature, T QuantizationOutput,
+            template<typename> typename Allocator = AlignedAllocator, uint8_t PsqtBuckets = 0,
+            InputLayout Layout = InputLayout::Full, AccumulatorLayout Storage = AccumulatorLayout::Split,
+            uint16_t ThreatInputs = 0>
     class PerspectiveNetwork
     {
 
-        // Support more types in the future, but currently disable all others.
-        static_assert(std::is_same_v<T, int16_t> && std::is_same_v<OT, int32_t>,
+        // Networks are either quantized into 16-bit integers or kept as trained in floats.
+        static_assert((std::is_same_v<T, int16_t> && std::is_same_v<OT, int32_t>) ||
+                      (std::is_same_v<T, float  > && std::is_same_v<OT, float  >),
                 "This type is currently not supported.");
 
+        // The PSQT outputs are only accumulated in integers.
+        static_assert(PsqtBuckets == 0 || std::is_integral_v<T>, "Float networks don't support PSQT outputs.");
+
         // Support less sizes in the future, but currently disable.
         static_assert(InputSize == 768 && HiddenSize >= 32, "This network size is currently not supported.");
 
@@ -54,96 +86,309 @@ namespace MantaRay
         static_assert(AccumulatorStackSize > 0, "The accumulator stack size must at least be greater than zero.");
 
         // The constants used should make sense. Change this later if requested.
-        static_assert(Scale > 0 && QuantizationFeature > 127 && QuantizationOutput > 31,
+        static_assert(Scale > 0 && (std::is_floating_point_v<T> || (QuantizationFeature > 127 &&
+                                                                    QuantizationOutput  > 31)),
                 "These scale and quantization constants don't seem right.");
 
-        private:
-            constexpr static uint16_t ColorStride = 64 * 6;
-            constexpr static uint8_t  PieceStride = 64    ;
+        public:
+            using Weights = PerspectiveWeights<T, InputSize, HiddenSize, OutputSize,
+                                               QuantizationFeature, QuantizationOutput, PsqtBuckets, Layout,
+                                               ThreatInputs>;
+
+            using Accumulator = PerspectiveAccumulator<T, HiddenSize, PsqtBuckets, Storage>;
+
+            /// \brief The number of rows of the feature weights.
+            constexpr static size_t Inputs = Weights::Features;
+
+            /// \brief The number of rows of the threat weights.
+            constexpr static uint16_t Threats = ThreatInputs;
+
+            /// \brief The indices of an input feature with respect to both perspectives.
+            struct Feature
+            {
+                uint32_t White;
+                uint32_t Black;
+            };
+
+            /// \brief A piece standing on a square of a position.
+            struct PieceSquare
+            {
+                uint8_t Piece;
+                uint8_t Color;
+                uint8_t Square;
+            };
+
+            /// \brief The rows of the threat features a move removes and adds, with respect to both perspectives.
+            /// \details The lists are indexed by perspective (white, then black) and may have any length, as the
+            ///          number of threats a move changes is only known at runtime.
+            struct ThreatDelta
+            {
+                std::array<std::span<const uint32_t>, 2> Removed;
+                std::array<std::span<const uint32_t>, 2> Added;
+            };
+
+            /// \brief The score of a position along with its win, draw, and loss probabilities.
+            struct WdlEvaluation
+            {
+                OT Score;
+
+                /// \brief The win, draw, and loss probabilities for the color to move, in permille.
+                std::array<uint16_t, 3> Wdl;
+            };
+
+            /// \brief Load weights and biases into memory provided by the allocation policy of the network.
+            /// \tparam Stream The type of the stream to read the weights and biases from.
+            /// \param stream The stream to read the weights and biases from.
+            /// \return The weights and biases, which can be shared by any number of networks.
+            template<typename Stream>
+            __attribute__((unused)) static std::shared_ptr<const Weights> LoadWeights(Stream& stream)
+            {
+                return std::allocate_shared<Weights>(Allocator<Weights>(), stream);
+            }
 
+        private:
+            // The number of accumulators evaluated per load of the output weights, bounded by the registers available
+            // to keep their sums in:
 #ifdef __AVX512BW__
-            alignas(64) std::array<T , InputSize * HiddenSize     > FeatureWeight;
-            alignas(64) std::array<T , HiddenSize                 > FeatureBias  ;
-            alignas(64) std::array<T , HiddenSize * 2 * OutputSize> OutputWeight ;
-            alignas(64) std::array<T , OutputSize                 > OutputBias   ;
-            alignas(64) std::array<OT, OutputSize                 > Output       ;
-#elifdef __AVX2__
-            alignas(32) std::array<T , InputSize * HiddenSize     > FeatureWeight;
-            alignas(32) std::array<T , HiddenSize                 > FeatureBias  ;
-            alignas(32) std::array<T , HiddenSize * 2 * OutputSize> OutputWeight ;
-            alignas(32) std::array<T , OutputSize                 > OutputBias   ;
-            alignas(32) std::array<OT, OutputSize                 > Output       ;
+            constexpr static size_t EvaluationTile = 8;
 #else
-            std::array<T , InputSize * HiddenSize     > FeatureWeight;
-            std::array<T , HiddenSize                 > FeatureBias  ;
-            std::array<T , HiddenSize * 2 * OutputSize> OutputWeight ;
-            std::array<T , OutputSize                 > OutputBias   ;
-            std::array<OT, OutputSize                 > Output       ;
+            constexpr static size_t EvaluationTile = 4;
 #endif
 
-            std::array<PerspectiveAccumulator<T, HiddenSize>, AccumulatorStackSize> Accumulators;
-            uint16_t CurrentAccumulator = 0;
+            /// \brief Scale an output of the network into an evaluation.
+            /// \param output The output of the network.
+            /// \return The evaluation.
+            /// \details Quantized outputs are dequantized, while float outputs only need to be scaled.
+            [[nodiscard]] constexpr static inline OT Dequantize(const OT output)
+            {
+                if constexpr (std::is_floating_point_v<T>) return output * Scale;
+                else return output * Scale / (QuantizationFeature * QuantizationOutput);
+            }
+
+            // The bytes of weight rows in flight when refreshing a batch, half of a 32 KB L1 data cache, leaving the
+            // other half to the accumulators being refreshed:
+            constexpr static size_t RefreshBytes = 16384;
+
+            // The number of features prefetched ahead of the one being accumulated when refreshing a batch. Every
+            // feature prefetches a row of each perspective, so networks too wide for two rows to fit in the budget
+            // still prefetch a single feature ahead:
+            constexpr static size_t RefreshDistance = std::max<size_t>(1, RefreshBytes /
+                                                                          (HiddenSize * sizeof(T) * 2));
+
+        public:
+            /// \brief The input feature of a piece on a square.
+            /// \param piece The piece.
+            /// \param color The color of the piece.
+            /// \param sq The square of the piece.
+            /// \return The indices of the feature with respect to both perspectives.
+            /// \details Networks sharing an input layout share their features, so the indices only need to be
+            ///          computed once for all of them.
+            /// \pre The piece can stand on the square in the input layout. Under MantaRay::InputLayout::Compact, pawns
+            ///      never stand on the first or last rank, so a promotion must remove the pawn from the square it
+            ///      leaves rather than move it to the last rank. This is only checked in debug builds, and every update
+            ///      taking pieces and squares shares this precondition.
+            [[nodiscard]] __attribute__((unused)) constexpr static inline Feature FeatureOf(const uint8_t piece,
+                                                                                            const uint8_t color,
+                                                                                            const uint8_t sq)
+            {
+                constexpr auto& Index = InputFeatures<Layout>::Index;
+
+                // Look up the rows for the square of the piece with respect to both perspectives:
+                const Feature feature { Index[color][piece][sq], Index[color ^ 1][piece][sq ^ 56] };
+
+                // Features that can never occur have no row:
+                assert(feature.White != InputFeatures<Layout>::Dead);
+
+                return feature;
+            }
+
+        private:
+            // The version is declared first, as it is written while acquiring the weights from a handle:
+            uint64_t WeightVersion = 0;
+            std::shared_ptr<const Weights> WeightSet;
+
+            std::vector<Accumulator, Allocator<Accumulator>> Accumulators;
+            size_t CurrentAccumulator = 0;
+
+            // The index of the guard slot past the end of the usable stack, which absorbs pushes that overflow:
+            size_t GuardAccumulator = AccumulatorStackSize;
+            bool Overflow = false;
+
+            EvaluationCache* Cache = nullptr;
 
             /// \brief Initializes the accumulator stack.
-            /// \details This function initializes the accumulator stack with empty accumulators.
-            void InitializeAccumulatorStack()
+            /// \param stackSize The number of usable accumulators on the stack.
+            /// \details This function allocates the accumulator stack with empty accumulators, along with the guard
+            ///          slot.
+            void InitializeAccumulatorStack(const size_t stackSize)
             {
-                PerspectiveAccumulator<T, HiddenSize> accumulator;
-                std::fill(std::begin(Accumulators), std::end(Accumulators), accumulator);
+                assert(stackSize > 0);
+
+                GuardAccumulator = stackSize;
+                Accumulators.resize(stackSize + 1);
+            }
+
+            /// \brief Updates the PSQT outputs of a child accumulator from its parent with a piece move.
+            /// \param parent The accumulator of the position before the move.
+            /// \param child The accumulator of the position after the move.
+            /// \param from The feature the piece is moved from.
+            /// \param to The feature the piece is moved to.
+            inline void MovePsqt(const Accumulator& parent, Accumulator& child, const Feature from,
+                                 const Feature to) const
+            {
+                const int32_t* weight = WeightSet->PsqtWeight.data();
+
+                for (size_t i = 0; i < PsqtBuckets; i++) {
+                    child.WhitePsqt[i] = parent.WhitePsqt[i] - weight[from.White * PsqtBuckets + i]
+                                                             + weight[to  .White * PsqtBuckets + i];
+                    child.BlackPsqt[i] = parent.BlackPsqt[i] - weight[from.Black * PsqtBuckets + i]
+                                                             + weight[to  .Black * PsqtBuckets + i];
+                }
+            }
+
+            /// \brief Updates the PSQT outputs of a child accumulator from its parent with a piece insertion or
+            ///        removal.
+            /// \tparam Operation The operation to perform on the accumulator.
+            /// \param parent The accumulator of the position before the insertion or removal.
+            /// \param child The accumulator of the position after the insertion or removal.
+            /// \param feature The feature.
+            template<AccumulatorOperation Operation>
+            inline void UpdatePsqt(const Accumulator& parent, Accumulator& child, const Feature feature) const
+            {
+                const int32_t* weight = WeightSet->PsqtWeight.data();
+
+                for (size_t i = 0; i < PsqtBuckets; i++) {
+                    if (Operation == AccumulatorOperation::Activate) {
+                        child.WhitePsqt[i] = parent.WhitePsqt[i] + weight[feature.White * PsqtBuckets + i];
+                        child.BlackPsqt[i] = parent.BlackPsqt[i] + weight[feature.Black * PsqtBuckets + i];
+                    } else {
+                        child.WhitePsqt[i] = parent.WhitePsqt[i] - weight[feature.White * PsqtBuckets + i];
+                        child.BlackPsqt[i] = parent.BlackPsqt[i] - weight[feature.Black * PsqtBuckets + i];
+                    }
+                }
+            }
+
+            /// \brief Prefetch the weights of a feature with respect to both perspectives.
+            /// \param feature The feature.
+            /// \details Every cache line of the feature's weight rows is prefetched, including its PSQT weights.
+            inline void PrefetchFeature(const Feature feature) const
+            {
+                const T* white = WeightSet->FeatureWeight.data() + feature.White * HiddenSize;
+                const T* black = WeightSet->FeatureWeight.data() + feature.Black * HiddenSize;
+
+                // Prefetch every cache line of both rows:
+                constexpr size_t Line = 64 / sizeof(T);
+                for (size_t i = 0; i < HiddenSize; i += Line) {
+                    __builtin_prefetch(white + i);
+                    __builtin_prefetch(black + i);
+                }
+
+                if constexpr (PsqtBuckets > 0) {
+                    __builtin_prefetch(WeightSet->PsqtWeight.data() + feature.White * PsqtBuckets);
+                    __builtin_prefetch(WeightSet->PsqtWeight.data() + feature.Black * PsqtBuckets);
+                }
+            }
+
+            /// \brief Accumulates the biases and the features of both perspectives into an accumulator at once.
+            /// \param accumulator The accumulator.
+            /// \param white The rows of the features with respect to white.
+            /// \param black The rows of the features with respect to black.
+            /// \param count The number of features of every perspective.
+            inline void AccumulateFeatures(Accumulator& accumulator, const uint16_t* white, const uint16_t* black,
+                                           const size_t count) const
+            {
+                SIMD::AccumulateRows<Storage>(WeightSet->FeatureBias, WeightSet->FeatureWeight, white, black, count,
+                                              accumulator.Values);
+
+                if constexpr (PsqtBuckets > 0) {
+                    const int32_t* weight = WeightSet->PsqtWeight.data();
+
+                    // Sum in locals, which can't alias the weights:
+                    std::array<int32_t, PsqtBuckets> whitePsqt {};
+                    std::array<int32_t, PsqtBuckets> blackPsqt {};
+                    for (size_t f = 0; f < count; f++)
+                        for (size_t i = 0; i < PsqtBuckets; i++) {
+                            whitePsqt[i] += weight[white[f] * PsqtBuckets + i];
+                            blackPsqt[i] += weight[black[f] * PsqtBuckets + i];
+                        }
+
+                    accumulator.WhitePsqt = whitePsqt;
+                    accumulator.BlackPsqt = blackPsqt;
+                }
             }
 
         public:
             /// \brief Constructs a new PerspectiveNetwork.
+            /// \param stackSize The size of the accumulator stack, such as the maximum search depth.
             /// \details This constructor initializes the network with undefined weights and biases.
-            __attribute__((unused)) PerspectiveNetwork()
+            __attribute__((unused)) explicit PerspectiveNetwork(const size_t stackSize = AccumulatorStackSize) :
+            WeightSet(std::allocate_shared<Weights>(Allocator<Weights>()))
             {
-                InitializeAccumulatorStack();
+                InitializeAccumulatorStack(stackSize);
             }
 
             /// \brief Constructs a new PerspectiveNetwork.
-            /// \param stream The binary file stream to read the network from.
-            /// \details This constructor initializes the network with the weights and biases read from the stream.
-            __attribute__((unused)) explicit PerspectiveNetwork(BinaryFileStream &stream)
+            /// \param weights The weights and biases to use.
+            /// \param stackSize The size of the accumulator stack, such as the maximum search depth.
+            /// \details This constructor initializes the network with weights and biases that may be shared with
+            ///          other networks, such as the networks of other search threads.
+            __attribute__((unused)) explicit PerspectiveNetwork(std::shared_ptr<const Weights> weights,
+                                                                const size_t stackSize = AccumulatorStackSize) :
+            WeightSet(std::move(weights))
             {
-                InitializeAccumulatorStack();
+                InitializeAccumulatorStack(stackSize);
+            }
 
-                stream.ReadArray(FeatureWeight);
-                stream.ReadArray(FeatureBias  );
-                stream.ReadArray(OutputWeight );
-                stream.ReadArray(OutputBias   );
+            /// \brief Constructs a new PerspectiveNetwork.
+            /// \param handle The handle to acquire the weights and biases from.
+            /// \param stackSize The size of the accumulator stack, such as the maximum search depth.
+            /// \details This constructor initializes the network with the current weights and biases of the handle.
+            /// \see MantaRay::PerspectiveNetwork::Synchronize for picking up weights that replace them later.
+            __attribute__((unused)) explicit PerspectiveNetwork(const WeightHandle<Weights>& handle,
+                                                                const size_t stackSize = AccumulatorStackSize) :
+            WeightSet(handle.Acquire(WeightVersion))
+            {
+                InitializeAccumulatorStack(stackSize);
             }
 
             /// \brief Constructs a new PerspectiveNetwork.
-            /// \param stream The binary memory stream to read the network from.
+            /// \param stream The binary file stream to read the network from.
+            /// \param stackSize The size of the accumulator stack, such as the maximum search depth.
             /// \details This constructor initializes the network with the weights and biases read from the stream.
-            __attribute__((unused)) explicit PerspectiveNetwork(BinaryMemoryStream &stream)
-            {
-                InitializeAccumulatorStack();
+            __attribute__((unused)) explicit PerspectiveNetwork(BinaryFileStream &stream,
+                                                                const size_t stackSize = AccumulatorStackSize) :
+            PerspectiveNetwork(LoadWeights(stream), stackSize) {}
 
-                stream.ReadArray(FeatureWeight);
-                stream.ReadArray(FeatureBias  );
-                stream.ReadArray(OutputWeight );
-                stream.ReadArray(OutputBias   );
-            }
+            /// \brief Constructs a new PerspectiveNetwork.
+            /// \param stream The binary memory stream to read the network from.
+            /// \param stackSize The size of the accumulator stack, such as the maximum search depth.
+            /// \details This constructor initializes the network with the weights and biases read from the stream.
+            __attribute__((unused)) explicit PerspectiveNetwork(BinaryMemoryStream &stream,
+                                                                const size_t stackSize = AccumulatorStackSize) :
+            PerspectiveNetwork(LoadWeights(stream), stackSize) {}
 
             /// \brief Constructs a new PerspectiveNetwork.
             /// \param stream The Marlinflow JSON stream to read the network from.
+            /// \param stackSize The size of the accumulator stack, such as the maximum search depth.
             /// \details This constructor initializes the network with the weights and biases read from the stream.
-            ///          Internally, this constructor also quantizes the weights and biases. It also permutes the
-            ///          weights to ensure better performance with respect to the cache. This constructor is only
-            ///          there to ensure compatibility with the Marlinflow JSON network format.
-            __attribute__((unused)) explicit PerspectiveNetwork(MarlinflowStream &stream)
-            {
-                InitializeAccumulatorStack();
-
-                stream.Read2DArray("ft.weight" , FeatureWeight, HiddenSize    , QuantizationFeature,
-                                   true );
-                stream.Read2DArray("out.weight", OutputWeight , HiddenSize * 2, QuantizationOutput ,
-                                   false);
+            ///          Internally, this constructor also quantizes the weights and biases, unless the network is a
+            ///          float network. It also permutes the weights to ensure better performance with respect to the
+            ///          cache. This constructor is only there to ensure compatibility with the Marlinflow JSON network
+            ///          format.
+            __attribute__((unused)) explicit PerspectiveNetwork(MarlinflowStream &stream,
+                                                                const size_t stackSize = AccumulatorStackSize) :
+            PerspectiveNetwork(LoadWeights(stream), stackSize) {}
 
-                stream.ReadArray("ft.bias" , FeatureBias, QuantizationFeature                     );
-                stream.ReadArray("out.bias", OutputBias , QuantizationFeature * QuantizationOutput);
-            }
+            /// \brief Constructs a new PerspectiveNetwork.
+            /// \param stream The float32 tensor stream to read the network from.
+            /// \param stackSize The size of the accumulator stack, such as the maximum search depth.
+            /// \details This constructor initializes the network with the weights and biases read from the stream,
+            ///          which must contain the feature weights, feature bias, output weights and output bias as
+            ///          little-endian float32 tensors, in this order and shaped like their Marlinflow counterparts.
+            ///          The weights and biases are quantized and permuted while they are streamed.
+            __attribute__((unused)) explicit PerspectiveNetwork(FloatBinaryStream &stream,
+                                                                const size_t stackSize = AccumulatorStackSize) :
+            PerspectiveNetwork(LoadWeights(stream), stackSize) {}
 
             /// \brief Provides information about the network.
             /// \return A string containing information about the network.
@@ -159,9 +404,11 @@ namespace MantaRay
                 ss << " | " << "First  Layer Size    : " << InputSize                   << std::endl;
                 ss << " | " << "Hidden Layer Size    : " << HiddenSize                  << std::endl;
                 ss << " | " << "Output Layer Size    : " << OutputSize                  << std::endl;
-                ss << " | " << "Input ->Hidden Weight: " <<  InputSize *     HiddenSize << std::endl;
+                ss << " | " << "Input ->Hidden Weight: " <<  Inputs    *     HiddenSize << std::endl;
                 ss << " | " << "Hidden->Output Weight: " << HiddenSize * 2 * OutputSize << std::endl;
-                ss << " | " << "AccumulatorStackSize : " << AccumulatorStackSize        << std::endl;
+                ss << " | " << "AccumulatorStackSize : " << GuardAccumulator            << std::endl;
+                ss << " | " << "PSQT Buckets         : " << static_cast<int>(PsqtBuckets) << std::endl;
+                ss << " | " << "Threat Inputs        : " << ThreatInputs                << std::endl;
                 ss << " | " << "Scale                : " << Scale                       << std::endl;
                 ss << " | " << "QuantizationFeature  : " << QuantizationFeature         << std::endl;
                 ss << " | " << "QuantizationOutput   : " << QuantizationOutput          << std::endl;
@@ -173,30 +420,86 @@ namespace MantaRay
             /// \details This function writes the weights and biases of the network to the stream.
             __attribute__((unused)) void WriteTo(BinaryFileStream &stream)
             {
-                stream.WriteMode();
+                WeightSet->WriteTo(stream);
+            }
+
+            /// \brief Synchronizes the network with the current weights of a handle.
+            /// \param handle The handle to synchronize with.
+            /// \return Whether the weights were replaced, in which case the accumulator must be refreshed.
+            /// \details This function is meant to be called at the root of every search. It only compares versions
+            ///          unless the weights of the handle were replaced since the last synchronization, in which case
+            ///          the network switches to the new weights and resets its accumulator stack, as the
+            ///          accumulators built with the previous weights are no longer valid. The previous weights are
+            ///          released, and freed once no other network uses them.
+            __attribute__((unused)) bool Synchronize(const WeightHandle<Weights>& handle)
+            {
+                // Keep using the current weights if they are still the latest:
+                if (handle.Version() == WeightVersion) return false;
+
+                WeightSet = handle.Acquire(WeightVersion);
+                ResetAccumulator();
+                return true;
+            }
+
+            /// \brief Attach an evaluation cache to the network.
+            /// \param cache The cache, which may be shared with other networks, or nullptr to detach the cache.
+            /// \details Once attached, evaluations given a position hash are served from the cache when possible.
+            ///          Entries are keyed by the process-unique identity of the weights as well, so networks with
+            ///          different weights can share a cache, and weights synchronized from a handle never see entries
+            ///          of the weights they replaced.
+            __attribute__((unused)) void AttachCache(EvaluationCache* cache)
+            {
+                Cache = cache;
+            }
+
+            /// \brief The weights and biases used by the network.
+            /// \return The weights and biases, which may be shared with other networks.
+            [[nodiscard]] __attribute__((unused)) const std::shared_ptr<const Weights>& SharedWeights() const
+            {
+                return WeightSet;
+            }
 
-                stream.WriteArray(FeatureWeight);
-                stream.WriteArray(FeatureBias  );
-                stream.WriteArray(OutputWeight );
-                stream.WriteArray(OutputBias   );
+            /// \brief The size of the accumulator stack.
+            /// \return The number of accumulators that can be pushed to before the stack overflows.
+            [[nodiscard]] __attribute__((unused)) inline size_t StackSize() const
+            {
+                return GuardAccumulator;
+            }
+
+            /// \brief Whether the accumulator stack overflowed since it was last reset.
+            /// \return True if a push went past the end of the stack.
+            /// \details Pushes past the end of the stack are absorbed by a guard slot, so they never write out of
+            ///          bounds, but the accumulators pulled back to afterwards are no longer valid. An engine should
+            ///          check this at the end of a search, or size the stack from its maximum search depth.
+            [[nodiscard]] __attribute__((unused)) inline bool Overflowed() const
+            {
+                return Overflow;
             }
 
             /// \brief Reset the accumulator stack counter.
-            /// \details This function resets the accumulator stack counter to zero.
+            /// \details This function resets the accumulator stack counter to zero, and clears the overflow flag.
             __attribute__((unused)) inline void ResetAccumulator()
             {
                 CurrentAccumulator = 0;
+                Overflow = false;
             }
 
             /// \brief Pushes the current accumulator to the stack.
             /// \details This function pushes the current accumulator to the stack. This is useful when you want to
             ///          efficiently update the accumulator with a new piece move, but you want to keep the current
-            ///          accumulator for later use (such as undoing).
+            ///          accumulator for later use (such as undoing). Overflowing the stack is caught without any
+            ///          branches: the push is clamped to the guard slot and the overflow flag is set.
+            /// \see MantaRay::PerspectiveNetwork::Overflowed for checking whether the stack overflowed.
             __attribute__((unused)) inline void PushAccumulator()
             {
-                Accumulators[CurrentAccumulator].CopyTo(Accumulators[++CurrentAccumulator]);
+                const size_t previous = CurrentAccumulator;
+                const size_t next     = previous + 1;
 
-                assert(CurrentAccumulator < AccumulatorStackSize);
+                // Clamp the push to the guard slot and remember if it was hit:
+                Overflow |= next >= GuardAccumulator;
+                CurrentAccumulator = std::min(next, GuardAccumulator);
+
+                Accumulators[previous].CopyTo(Accumulators[CurrentAccumulator]);
             }
 
             /// \brief Pulls the current accumulator from the stack.
@@ -209,14 +512,287 @@ namespace MantaRay
                 CurrentAccumulator--;
             }
 
+            /// \brief Refreshes an accumulator.
+            /// \param accumulator The accumulator to refresh.
+            /// \details This function refreshes the accumulator with the bias, effectively resetting it to the
+            ///          initial state before any pieces were accumulated. The accumulator may be owned by the caller,
+            ///          such as an accumulator embedded in the ply structures of the engine's search stack.
+            __attribute__((unused)) inline void RefreshAccumulator(Accumulator& accumulator) const
+            {
+                accumulator.LoadBias(WeightSet->FeatureBias);
+            }
+
             /// \brief Refreshes the current accumulator.
             /// \details This function refreshes the current accumulator with the bias, effectively resetting it to
             ///          the initial state before any pieces were accumulated.
             __attribute__((unused)) inline void RefreshAccumulator()
             {
-                PerspectiveAccumulator<T, HiddenSize>& accumulator = Accumulators[CurrentAccumulator];
-                accumulator.Zero();
-                accumulator.LoadBias(FeatureBias);
+                RefreshAccumulator(Accumulators[CurrentAccumulator]);
+            }
+
+            /// \brief Refreshes an accumulator from a position.
+            /// \param accumulator The accumulator to refresh, which may be owned by the caller.
+            /// \param position The position.
+            /// \details The features of both perspectives are extracted from the bitboards of the position, and every
+            ///          register of the accumulator is computed from the bias and all the features before it is stored,
+            ///          rather than activating the pieces one by one.
+            __attribute__((unused)) inline void RefreshAccumulator(Accumulator& accumulator,
+                                                                   const Position& position) const
+            {
+                std::array<uint16_t, Position::MaxPieces> white;
+                std::array<uint16_t, Position::MaxPieces> black;
+
+                const size_t count = position.Features<Layout>(white.data(), black.data());
+                AccumulateFeatures(accumulator, white.data(), black.data(), count);
+            }
+
+            /// \brief Refreshes the current accumulator from a position.
+            /// \param position The position.
+            /// \see MantaRay::PerspectiveNetwork::RefreshAccumulator(Accumulator&, const Position&) for the details.
+            __attribute__((unused)) inline void RefreshAccumulator(const Position& position)
+            {
+                RefreshAccumulator(Accumulators[CurrentAccumulator], position);
+            }
+
+            /// \brief Refreshes an accumulator from a position and its threat features.
+            /// \param accumulator The accumulator to refresh, which may be owned by the caller.
+            /// \param position The position.
+            /// \param threats The rows of the threat features present in the position, for the white and black
+            ///                perspective.
+            /// \details The piece-square features are refreshed from the bitboards of the position, after which the
+            ///          threat features are added in one more pass over the accumulator.
+            __attribute__((unused)) inline void RefreshAccumulator(
+                    Accumulator& accumulator, const Position& position,
+                    const std::array<std::span<const uint32_t>, 2>& threats) const
+            {
+                static_assert(ThreatInputs > 0, "The network has no threat features.");
+
+                RefreshAccumulator(accumulator, position);
+                EfficientlyUpdateAccumulator(accumulator, accumulator, std::array<Feature, 0> {},
+                                             std::array<Feature, 0> {}, ThreatDelta { {}, threats });
+            }
+
+            /// \brief Refreshes a batch of accumulators from unrelated positions.
+            /// \param positions The positions.
+            /// \param accumulators The accumulator of every position, which may be owned by the caller.
+            /// \details The features of the next position are extracted and their weight rows prefetched while the
+            ///          current position is accumulated, so the rows of a position have arrived by the time it is
+            ///          refreshed.
+            __attribute__((unused)) void RefreshBatch(const std::span<const Position> positions,
+                                                      const std::span<Accumulator> accumulators) const
+            {
+                static_assert(ThreatInputs == 0, "Batches are refreshed without the threat features.");
+
+                assert(positions.size() == accumulators.size());
+                if (positions.empty()) return;
+
+                // The features of the current and the next position:
+                std::array<std::array<uint16_t, Position::MaxPieces>, 2> white;
+                std::array<std::array<uint16_t, Position::MaxPieces>, 2> black;
+                std::array<size_t, 2> count {};
+
+                count[0] = positions[0].Features<Layout>(white[0].data(), black[0].data());
+
+                for (size_t i = 0; i < positions.size(); i++) {
+                    const size_t current = i & 1;
+                    const size_t next    = current ^ 1;
+
+                    if (i + 1 < positions.size()) {
+                        count[next] = positions[i + 1].Features<Layout>(white[next].data(), black[next].data());
+                        for (size_t f = 0; f < count[next]; f++)
+                            PrefetchFeature({ white[next][f], black[next][f] });
+                    }
+
+                    AccumulateFeatures(accumulators[i], white[current].data(), black[current].data(),
+                                       count[current]);
+                }
+            }
+
+            /// \brief Refreshes a batch of accumulators from the pieces of unrelated positions.
+            /// \param positions The pieces of every position.
+            /// \param accumulators The accumulator of every position, which may be owned by the caller.
+            /// \details The weight rows of unrelated positions are cold in cache, so accumulating them one after the
+            ///          other stalls on memory for every feature. Instead, the pieces of all positions are walked as a
+            ///          single pipeline: the feature of a piece a fixed distance ahead (crossing into the next
+            ///          positions as needed) is computed and its weight rows prefetched while the current feature is
+            ///          accumulated.
+            ///          By the time a feature is accumulated, its rows have arrived, so the refresh is bound by memory
+            ///          bandwidth rather than latency.
+            __attribute__((unused)) void RefreshBatch(const std::span<const std::span<const PieceSquare>> positions,
+                                                      const std::span<Accumulator> accumulators) const
+            {
+                static_assert(ThreatInputs == 0, "Batches are refreshed without the threat features.");
+
+                assert(positions.size() == accumulators.size());
+
+                // The features computed ahead of being accumulated, in the order they are accumulated in:
+                std::array<Feature, RefreshDistance> features;
+
+                // The position and piece of the next feature to compute:
+                size_t aheadPosition = 0;
+                size_t aheadPiece    = 0;
+
+                // Compute the next feature and prefetch its weights, if there is one left:
+                const auto fetch = [&](Feature& feature) {
+                    while (aheadPosition < positions.size() && aheadPiece == positions[aheadPosition].size()) {
+                        aheadPosition++;
+                        aheadPiece = 0;
+                    }
+
+                    if (aheadPosition == positions.size()) return;
+
+                    const PieceSquare& piece = positions[aheadPosition][aheadPiece++];
+
+                    feature = FeatureOf(piece.Piece, piece.Color, piece.Square);
+                    PrefetchFeature(feature);
+                };
+
+                // Fill the pipeline:
+                for (Feature& feature : features) fetch(feature);
+
+                size_t slot = 0;
+                for (size_t i = 0; i < positions.size(); i++) {
+                    Accumulator& accumulator = accumulators[i];
+                    RefreshAccumulator(accumulator);
+
+                    for (size_t j = 0; j < positions[i].size(); j++) {
+                        const Feature feature = features[slot];
+
+                        // Replace the consumed feature with the one a full pipeline ahead:
+                        fetch(features[slot]);
+                        slot = (slot + 1) % RefreshDistance;
+
+                        EfficientlyUpdateAccumulator<AccumulatorOperation::Activate>(accumulator, accumulator, feature);
+                    }
+                }
+            }
+
+            /// \brief Prefetch the weights a piece move will update the accumulator with.
+            /// \param piece The piece that is moved.
+            /// \param color The color of the piece that is moved.
+            /// \param from The square the piece is moved from.
+            /// \param to The square the piece is moved to.
+            /// \details The weight rows read by an update are effectively random per move, and miss the cache for
+            ///          large networks. Calling this function as early as the move is known, such as right after
+            ///          picking it in move ordering, hides that latency behind the work done until the update.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
+            __attribute__((unused)) inline void PrefetchUpdate(const uint8_t piece, const uint8_t color,
+                                                               const uint8_t from, const uint8_t to) const
+            {
+                PrefetchFeature(FeatureOf(piece, color, from));
+                PrefetchFeature(FeatureOf(piece, color, to  ));
+            }
+
+            /// \brief Prefetch the weights a capturing piece move will update the accumulator with.
+            /// \param piece The piece that is moved.
+            /// \param color The color of the piece that is moved.
+            /// \param from The square the piece is moved from.
+            /// \param to The square the piece is moved to.
+            /// \param captured The piece that is captured.
+            /// \param capturedColor The color of the piece that is captured.
+            /// \param capturedSq The square of the piece that is captured, which differs from the destination for en
+            ///                   passant captures.
+            /// \details This function prefetches every row of the multi-feature update a capture performs.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
+            __attribute__((unused)) inline void PrefetchUpdate(const uint8_t piece, const uint8_t color,
+                                                               const uint8_t from, const uint8_t to,
+                                                               const uint8_t captured, const uint8_t capturedColor,
+                                                               const uint8_t capturedSq) const
+            {
+                PrefetchFeature(FeatureOf(piece   , color        , from      ));
+                PrefetchFeature(FeatureOf(piece   , color        , to        ));
+                PrefetchFeature(FeatureOf(captured, capturedColor, capturedSq));
+            }
+
+            /// \brief Prefetch the weights a piece insertion or removal will update the accumulator with.
+            /// \param piece The piece that is inserted or removed.
+            /// \param color The color of the piece that is inserted or removed.
+            /// \param sq The square the piece is inserted or removed from.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
+            __attribute__((unused)) inline void PrefetchUpdate(const uint8_t piece, const uint8_t color,
+                                                               const uint8_t sq) const
+            {
+                PrefetchFeature(FeatureOf(piece, color, sq));
+            }
+
+            /// \brief Efficiently updates a child accumulator from its parent with a feature move.
+            /// \param parent The accumulator of the position before the move.
+            /// \param child The accumulator of the position after the move, which may be the parent itself.
+            /// \param from The feature of the piece before the move.
+            /// \param to The feature of the piece after the move.
+            /// \details This function reads the parent and writes the child in a single pass, so pushing a ply
+            ///          costs no separate copy. Both accumulators may be owned by the caller.
+            /// \see MantaRay::PerspectiveNetwork::FeatureOf for computing the features.
+            __attribute__((unused)) inline void EfficientlyUpdateAccumulator(const Accumulator& parent,
+                                                                             Accumulator& child,
+                                                                             const Feature from,
+                                                                             const Feature to) const
+            {
+                // Efficiently update the child from the parent:
+                SIMD::SubtractAndAddToAll<Storage>(parent.Values, child.Values,
+                                                   WeightSet->FeatureWeight,
+                                                   from.White * HiddenSize,
+                                                   to  .White * HiddenSize,
+                                                   from.Black * HiddenSize,
+                                                   to  .Black * HiddenSize);
+
+                // Update the PSQT outputs in a separate scalar loop, as there are only a few buckets:
+                if constexpr (PsqtBuckets > 0) MovePsqt(parent, child, from, to);
+            }
+
+            /// \brief Efficiently updates a child accumulator from its parent with a new piece move.
+            /// \param parent The accumulator of the position before the move.
+            /// \param child The accumulator of the position after the move, which may be the parent itself.
+            /// \param piece The piece that is moved.
+            /// \param color The color of the piece that is moved.
+            /// \param from The square the piece is moved from.
+            /// \param to The square the piece is moved to.
+            /// \details This function reads the parent and writes the child in a single pass, so pushing a ply
+            ///          costs no separate copy. Both accumulators may be owned by the caller.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
+            __attribute__((unused)) inline void EfficientlyUpdateAccumulator(const Accumulator& parent,
+                                                                             Accumulator& child,
+                                                                             const uint8_t piece, const uint8_t color,
+                                                                             const uint8_t from, const uint8_t to) const
+            {
+                EfficientlyUpdateAccumulator(parent, child, FeatureOf(piece, color, from), FeatureOf(piece, color, to));
+            }
+
+            /// \brief Efficiently updates a child accumulator from its parent with a new piece move and the threat
+            ///        features it changes.
+            /// \param parent The accumulator of the position before the move.
+            /// \param child The accumulator of the position after the move, which may be the parent itself.
+            /// \param piece The piece that is moved.
+            /// \param color The color of the piece that is moved.
+            /// \param from The square the piece is moved from.
+            /// \param to The square the piece is moved to.
+            /// \param threats The threat features that are removed and inserted by the move.
+            /// \details The piece move and every threat feature are applied in a single pass over the accumulator.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
+            __attribute__((unused)) inline void EfficientlyUpdateAccumulator(const Accumulator& parent,
+                                                                             Accumulator& child,
+                                                                             const uint8_t piece, const uint8_t color,
+                                                                             const uint8_t from, const uint8_t to,
+                                                                             const ThreatDelta& threats) const
+            {
+                const std::array<Feature, 1> removed = { FeatureOf(piece, color, from) };
+                const std::array<Feature, 1> added   = { FeatureOf(piece, color, to  ) };
+
+                EfficientlyUpdateAccumulator(parent, child, removed, added, threats);
+            }
+
+            /// \brief Efficiently updates an accumulator in-place with a new piece move.
+            /// \param accumulator The accumulator to update.
+            /// \param piece The piece that is moved.
+            /// \param color The color of the piece that is moved.
+            /// \param from The square the piece is moved from.
+            /// \param to The square the piece is moved to.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
+            __attribute__((unused)) inline void EfficientlyUpdateAccumulator(Accumulator& accumulator,
+                                                                             const uint8_t piece, const uint8_t color,
+                                                                             const uint8_t from, const uint8_t to) const
+            {
+                EfficientlyUpdateAccumulator(accumulator, accumulator, piece, color, from, to);
             }
 
             /// \brief Efficiently updates the current accumulator with a new piece move.
@@ -228,30 +804,189 @@ namespace MantaRay
             ///          done by subtracting the piece from the square it is moved from and adding it to the square
             ///          it is moved to. This is much more efficient than calling RefreshAccumulator() and then
             ///          accumulating all pieces again.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
             __attribute__((unused)) inline void EfficientlyUpdateAccumulator(const uint8_t piece, const uint8_t color,
                                                                              const uint8_t from, const uint8_t to)
             {
-                // Calculate the stride necessary to get to the correct piece:
-                const uint16_t pieceStride = piece * PieceStride;
+                EfficientlyUpdateAccumulator(Accumulators[CurrentAccumulator], piece, color, from, to);
+            }
+
+            /// \brief Efficiently updates a child accumulator from its parent with a new piece insertion or removal.
+            /// \tparam Operation The operation to perform on the accumulator.
+            /// \param parent The accumulator of the position before the insertion or removal.
+            /// \param child The accumulator of the position after the insertion or removal, which may be the parent
+            ///              itself.
+            /// \param piece The piece that is inserted or removed.
+            /// \param color The color of the piece that is inserted or removed.
+            /// \param sq The square the piece is inserted or removed from.
+            /// \details This function reads the parent and writes the child in a single pass, so pushing a ply
+            ///          costs no separate copy. Both accumulators may be owned by the caller.
+            /// \see MantaRay::AccumulatorOperation for the available operations.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
+            template<AccumulatorOperation Operation>
+            __attribute__((unused)) inline void EfficientlyUpdateAccumulator(const Accumulator& parent,
+                                                                             Accumulator& child,
+                                                                             const uint8_t piece, const uint8_t color,
+                                                                             const uint8_t sq) const
+            {
+                EfficientlyUpdateAccumulator<Operation>(parent, child, FeatureOf(piece, color, sq));
+            }
+
+            /// \brief Efficiently updates a child accumulator from its parent with a feature insertion or removal.
+            /// \tparam Operation The operation to perform on the accumulator.
+            /// \param parent The accumulator of the position before the insertion or removal.
+            /// \param child The accumulator of the position after the insertion or removal, which may be the parent
+            ///              itself.
+            /// \param feature The feature that is inserted or removed.
+            /// \see MantaRay::PerspectiveNetwork::FeatureOf for computing the feature.
+            template<AccumulatorOperation Operation>
+            __attribute__((unused)) inline void EfficientlyUpdateAccumulator(const Accumulator& parent,
+                                                                             Accumulator& child,
+                                                                             const Feature feature) const
+            {
+                // Efficiently update the child from the parent:
+                if (Operation == AccumulatorOperation::Activate)
+                    SIMD::AddToAll<Storage>(parent.Values, child.Values,
+                                            WeightSet->FeatureWeight,
+                                            feature.White * HiddenSize,
+                                            feature.Black * HiddenSize);
+
+                else SIMD::SubtractFromAll<Storage>(parent.Values, child.Values,
+                                                    WeightSet->FeatureWeight,
+                                                    feature.White * HiddenSize,
+                                                    feature.Black * HiddenSize);
+
+                // Update the PSQT outputs in a separate scalar loop, as there are only a few buckets:
+                if constexpr (PsqtBuckets > 0) UpdatePsqt<Operation>(parent, child, feature);
+            }
+
+            /// \brief Efficiently updates a child accumulator from its parent with several feature removals and
+            ///        insertions at once.
+            /// \tparam Removed The number of features that are removed.
+            /// \tparam Added The number of features that are inserted.
+            /// \param parent The accumulator of the position before the update.
+            /// \param child The accumulator of the position after the update, which may be the parent itself.
+            /// \param removed The features that are removed.
+            /// \param added The features that are inserted.
+            /// \param threats The threat features that are removed and inserted, if the network has any.
+            /// \details Every register-sized tile of the parent is loaded once, has every feature applied to it while
+            ///          it stays in registers, and is stored once to the child. Updates made of several features, such
+            ///          as captures, castling and promotions, thus cost a single pass over the accumulator instead of
+            ///          one per feature. The threat features are applied in the same pass, from their own weights, so
+            ///          they don't cost another pass over the accumulator either. Threat features have no PSQT outputs.
+            /// \see MantaRay::PerspectiveNetwork::FeatureOf for computing the features.
+            template<size_t Removed, size_t Added>
+            __attribute__((unused)) inline void EfficientlyUpdateAccumulator(
+                    const Accumulator& parent, Accumulator& child,
+                    const std::array<Feature, Removed>& removed, const std::array<Feature, Added>& added,
+                    const ThreatDelta& threats = {}) const
+            {
+                // The threat rows index the threat weights, which have no rows if the network has no threats:
+                for (const auto& rows : { threats.Removed[0], threats.Removed[1], threats.Added[0], threats.Added[1] })
+                    for ([[maybe_unused]] const uint32_t row : rows) assert(row < ThreatInputs);
+
+                // Split the features into the rows of every perspective:
+                std::array<std::array<uint32_t, Removed>, 2> removedRows;
+                std::array<std::array<uint32_t, Added  >, 2> addedRows;
+
+                for (size_t i = 0; i < Removed; i++) {
+                    removedRows[0][i] = removed[i].White;
+                    removedRows[1][i] = removed[i].Black;
+                }
+
+                for (size_t i = 0; i < Added; i++) {
+                    addedRows[0][i] = added[i].White;
+                    addedRows[1][i] = added[i].Black;
+                }
+
+                SIMD::SubtractAndAddRows<Storage>(parent.Values, child.Values, WeightSet->FeatureWeight, removedRows,
+                                                  addedRows, WeightSet->ThreatWeight, threats.Removed, threats.Added);
+
+                // Update the PSQT outputs in a separate scalar loop, as there are only a few buckets:
+                if constexpr (PsqtBuckets > 0) {
+                    const int32_t* weight = WeightSet->PsqtWeight.data();
+
+                    for (size_t i = 0; i < PsqtBuckets; i++) {
+                        int32_t white = parent.WhitePsqt[i];
+                        int32_t black = parent.BlackPsqt[i];
+
+                        for (size_t r = 0; r < Removed; r++) {
+                            white -= weight[removed[r].White * PsqtBuckets + i];
+                            black -= weight[removed[r].Black * PsqtBuckets + i];
+                        }
 
-                // Calculate the indices for the square of the piece that is moved with respect to both perspectives:
-                const uint32_t whiteIndexFrom =  color       * ColorStride + pieceStride +        from;
-                const uint32_t blackIndexFrom = (color ^ 1)  * ColorStride + pieceStride + (from ^ 56);
+                        for (size_t r = 0; r < Added; r++) {
+                            white += weight[added[r].White * PsqtBuckets + i];
+                            black += weight[added[r].Black * PsqtBuckets + i];
+                        }
 
-                // Calculate the indices for the square the piece is moved to with respect to both perspectives:
-                const uint32_t whiteIndexTo   =  color       * ColorStride + pieceStride +          to;
-                const uint32_t blackIndexTo   = (color ^ 1)  * ColorStride + pieceStride + (  to ^ 56);
+                        child.WhitePsqt[i] = white;
+                        child.BlackPsqt[i] = black;
+                    }
+                }
+            }
 
-                // Fetch the current accumulator:
-                PerspectiveAccumulator<T, HiddenSize>& accumulator = Accumulators[CurrentAccumulator];
+            /// \brief Efficiently updates a child accumulator from its parent with a capturing piece move.
+            /// \param parent The accumulator of the position before the move.
+            /// \param child The accumulator of the position after the move, which may be the parent itself.
+            /// \param piece The piece that is moved.
+            /// \param color The color of the piece that is moved.
+            /// \param from The square the piece is moved from.
+            /// \param to The square the piece is moved to.
+            /// \param captured The piece that is captured.
+            /// \param capturedColor The color of the piece that is captured.
+            /// \param capturedSq The square of the piece that is captured, which differs from the destination for en
+            ///                   passant captures.
+            /// \param threats The threat features that are removed and inserted by the capture, if the network has
+            ///                any.
+            /// \details The three features of the capture, along with the threat features, are applied in a single
+            ///          pass over the accumulator.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
+            __attribute__((unused)) inline void EfficientlyUpdateAccumulator(const Accumulator& parent,
+                                                                             Accumulator& child,
+                                                                             const uint8_t piece, const uint8_t color,
+                                                                             const uint8_t from, const uint8_t to,
+                                                                             const uint8_t captured,
+                                                                             const uint8_t capturedColor,
+                                                                             const uint8_t capturedSq,
+                                                                             const ThreatDelta& threats = {}) const
+            {
+                const std::array<Feature, 2> removed = {
+                        FeatureOf(piece   , color        , from      ),
+                        FeatureOf(captured, capturedColor, capturedSq)
+                };
+                const std::array<Feature, 1> added = { FeatureOf(piece, color, to) };
+
+                EfficientlyUpdateAccumulator(parent, child, removed, added, threats);
+            }
 
-                // Efficiently update the accumulator:
-                SIMD::SubtractAndAddToAll(accumulator.White, accumulator.Black,
-                                          FeatureWeight,
-                                          whiteIndexFrom * HiddenSize,
-                                          whiteIndexTo   * HiddenSize,
-                                          blackIndexFrom * HiddenSize,
-                                          blackIndexTo   * HiddenSize);
+            /// \brief Efficiently updates the current accumulator with a capturing piece move.
+            /// \see MantaRay::PerspectiveNetwork::EfficientlyUpdateAccumulator for the parameters.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
+            __attribute__((unused)) inline void EfficientlyUpdateAccumulator(const uint8_t piece, const uint8_t color,
+                                                                             const uint8_t from, const uint8_t to,
+                                                                             const uint8_t captured,
+                                                                             const uint8_t capturedColor,
+                                                                             const uint8_t capturedSq)
+            {
+                Accumulator& accumulator = Accumulators[CurrentAccumulator];
+                EfficientlyUpdateAccumulator(accumulator, accumulator, piece, color, from, to, captured, capturedColor,
+                                             capturedSq);
+            }
+
+            /// \brief Efficiently updates an accumulator in-place with a new piece insertion or removal.
+            /// \tparam Operation The operation to perform on the accumulator.
+            /// \param accumulator The accumulator to update.
+            /// \param piece The piece that is inserted or removed.
+            /// \param color The color of the piece that is inserted or removed.
+            /// \param sq The square the piece is inserted or removed from.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
+            template<AccumulatorOperation Operation>
+            __attribute__((unused)) inline void EfficientlyUpdateAccumulator(Accumulator& accumulator,
+                                                                             const uint8_t piece, const uint8_t color,
+                                                                             const uint8_t sq) const
+            {
+                EfficientlyUpdateAccumulator<Operation>(accumulator, accumulator, piece, color, sq);
             }
 
             /// \brief Efficiently updates the current accumulator with a new piece insertion or removal.
@@ -264,34 +999,109 @@ namespace MantaRay
             ///          or removed from. This is much more efficient than calling the non-templated version of
             ///          this function.
             /// \see MantaRay::AccumulatorOperation for the available operations.
+            /// \pre The pieces can stand on their squares, see MantaRay::PerspectiveNetwork::FeatureOf.
             template<AccumulatorOperation Operation>
             __attribute__((unused)) inline void EfficientlyUpdateAccumulator(const uint8_t piece, const uint8_t color,
                                                                              const uint8_t sq)
             {
-                // Calculate the stride necessary to get to the correct piece:
-                const uint16_t pieceStride = piece * PieceStride;
+                EfficientlyUpdateAccumulator<Operation>(Accumulators[CurrentAccumulator], piece, color, sq);
+            }
 
-                // Calculate the indices for the square of the piece that is inserted or removed with respect to both
-                // perspectives:
-                const uint32_t whiteIndex =  color      * ColorStride + pieceStride +  sq      ;
-                const uint32_t blackIndex = (color ^ 1) * ColorStride + pieceStride + (sq ^ 56);
+            /// \brief Evaluates the network with respect to an accumulator.
+            /// \param accumulator The accumulator to evaluate, which may be owned by the caller.
+            /// \param colorToMove The color to move.
+            /// \return The evaluation of the network with respect to the accumulator.
+            /// \details This function evaluates the network with respect to the accumulator. The accumulator is
+            ///          assumed to be up to date with the position. As the function keeps no state, any number of
+            ///          threads may evaluate their own accumulators with the same network concurrently.
+            [[nodiscard]] __attribute__((unused)) inline OT Evaluate(const Accumulator& accumulator,
+                                                                     const uint8_t colorToMove) const
+            {
+                // Define the output of the network:
+                std::array<OT, OutputSize> output;
 
-                // Fetch the current accumulator:
-                PerspectiveAccumulator<T, HiddenSize>& accumulator = Accumulators[CurrentAccumulator];
+                // Activate, flatten, and forward-propagate the accumulator to evaluate the network, with the
+                // perspective of the color to move first:
+                SIMD::ActivateFlattenAndForward<Activation, Storage>(
+                        accumulator.Values,
+                        colorToMove,
+                        WeightSet->OutputWeight,
+                        WeightSet->OutputBias,
+                        output,
+                        0);
 
-                // Efficiently update the accumulator:
-                if (Operation == AccumulatorOperation::Activate)
-                    SIMD::AddToAll(accumulator.White,
-                                   accumulator.Black,
-                                   FeatureWeight,
-                                   whiteIndex * HiddenSize,
-                                   blackIndex * HiddenSize);
+                // Scale the output with respect to the quantization and return it:
+                return Dequantize(output[0]);
+            }
 
-                else SIMD::SubtractFromAll(accumulator.White,
-                                           accumulator.Black,
-                                           FeatureWeight,
-                                           whiteIndex * HiddenSize,
-                                           blackIndex * HiddenSize);
+            /// \brief Evaluates the network with respect to a batch of unrelated accumulators.
+            /// \param accumulators The accumulators to evaluate, which may be owned by the caller.
+            /// \param colorsToMove The color to move of every accumulator.
+            /// \param evaluations The evaluation of every accumulator.
+            /// \details The accumulators are evaluated in tiles, loading every output weight once per tile instead of
+            ///          once per accumulator, which makes evaluating many positions (such as when relabeling data or
+            ///          scoring MultiPV lines) considerably cheaper. The evaluations are identical to those of
+            ///          evaluating every accumulator on its own.
+            __attribute__((unused)) void EvaluateBatch(const std::span<const Accumulator* const> accumulators,
+                                                       const std::span<const uint8_t> colorsToMove,
+                                                       const std::span<OT> evaluations) const
+            {
+                assert(accumulators.size() == colorsToMove.size() && accumulators.size() == evaluations.size());
+
+                std::array<const std::array<T, HiddenSize * 2>*, EvaluationTile> values;
+                std::array<uint8_t, EvaluationTile> us;
+
+                std::array<std::array<OT, OutputSize>, EvaluationTile> output;
+
+                for (size_t i = 0; i < accumulators.size(); i += EvaluationTile) {
+                    const size_t count = std::min(EvaluationTile, accumulators.size() - i);
+
+                    // Gather the accumulators of the tile, padding a partial tile with its first accumulator:
+                    for (size_t t = 0; t < EvaluationTile; t++) {
+                        const size_t k = i + (t < count ? t : 0);
+
+                        values[t] = &accumulators[k]->Values;
+                        us    [t] = colorsToMove[k];
+                    }
+
+                    SIMD::ActivateFlattenAndForwardTile<Activation, Storage>(values, us, WeightSet->OutputWeight,
+                                                                             WeightSet->OutputBias, output);
+
+                    // Scale the outputs with respect to the quantization:
+                    for (size_t t = 0; t < count; t++)
+                        evaluations[i + t] = Dequantize(output[t][0]);
+                }
+            }
+
+            /// \brief Evaluates the network with respect to an accumulator, through the attached cache.
+            /// \param accumulator The accumulator to evaluate, which may be owned by the caller.
+            /// \param colorToMove The color to move.
+            /// \param hash The hash of the position, which must account for the color to move.
+            /// \return The evaluation of the network with respect to the accumulator.
+            /// \details On a cache hit, the network isn't run at all. Otherwise, the network is evaluated and the
+            ///          result is stored in the cache. Without an attached cache, this is the same as evaluating
+            ///          without a hash. Float networks always bypass the cache, which only holds whole centipawns.
+            /// \see MantaRay::PerspectiveNetwork::AttachCache for attaching a cache.
+            [[nodiscard]] __attribute__((unused)) inline OT Evaluate(const Accumulator& accumulator,
+                                                                     const uint8_t colorToMove,
+                                                                     const uint64_t hash) const
+            {
+                // Float evaluations can't be stored in the cache's integer entries:
+                if constexpr (std::is_floating_point_v<OT>) {
+                    return Evaluate(accumulator, colorToMove);
+                } else {
+                    if (Cache == nullptr) return Evaluate(accumulator, colorToMove);
+
+                    // Key the entry by the identity of the weights as well, as the evaluation depends on them:
+                    const uint64_t key = hash ^ (WeightSet->Identity.Get() * 0x9E3779B97F4A7C15);
+
+                    int16_t cached;
+                    if (Cache->Probe(key, cached)) return cached;
+
+                    const OT evaluation = Evaluate(accumulator, colorToMove);
+                    Cache->Store(key, evaluation);
+                    return evaluation;
+                }
             }
 
             /// \brief Evaluates the network with respect to the current accumulator.
@@ -302,27 +1112,86 @@ namespace MantaRay
             ///          returned as the output type of the network.
             __attribute__((unused)) inline OT Evaluate(const uint8_t colorToMove)
             {
-                // Fetch the current accumulator:
-                PerspectiveAccumulator<T, HiddenSize>& accumulator = Accumulators[CurrentAccumulator];
+                return Evaluate(Accumulators[CurrentAccumulator], colorToMove);
+            }
 
-                // Activate, flatten, and forward-propagate the accumulator to evaluate the network:
-                if (colorToMove == 0) SIMD::ActivateFlattenAndForward<Activation>(
-                        accumulator.White,
-                        accumulator.Black,
-                        OutputWeight,
-                        OutputBias,
-                        Output,
-                        0);
-                else                  SIMD::ActivateFlattenAndForward<Activation>(
-                        accumulator.Black,
-                        accumulator.White,
-                        OutputWeight,
-                        OutputBias,
-                        Output,
+            /// \brief Evaluates the network with respect to the current accumulator, through the attached cache.
+            /// \param colorToMove The color to move.
+            /// \param hash The hash of the position, which must account for the color to move.
+            /// \return The evaluation of the network with respect to the current accumulator.
+            __attribute__((unused)) inline OT Evaluate(const uint8_t colorToMove, const uint64_t hash)
+            {
+                return Evaluate(Accumulators[CurrentAccumulator], colorToMove, hash);
+            }
+
+            /// \brief Evaluates the score and the win, draw, and loss probabilities of an accumulator.
+            /// \param accumulator The accumulator to evaluate, which may be owned by the caller.
+            /// \param colorToMove The color to move.
+            /// \return The score, in the same units as Evaluate, and the win, draw, and loss probabilities.
+            /// \details The network must have four outputs: the score, followed by the win, draw, and loss logits. All
+            ///          of them are computed in a single pass over the accumulator, so this costs about as much as
+            ///          Evaluate. The probabilities are the fixed-point softmax of the logits.
+            [[nodiscard]] __attribute__((unused)) inline WdlEvaluation EvaluateWdl(const Accumulator& accumulator,
+                                                                                   const uint8_t colorToMove) const
+            {
+                static_assert(OutputSize == 4, "The network must output a score and win, draw, and loss logits.");
+
+                // Define the output of the network:
+                std::array<OT, OutputSize> output;
+
+                // Activate, flatten, and forward-propagate the accumulator through every output at once, with the
+                // perspective of the color to move first:
+                SIMD::ActivateFlattenAndForward<Activation, Storage>(
+                        accumulator.Values,
+                        colorToMove,
+                        WeightSet->OutputWeight,
+                        WeightSet->OutputBias,
+                        output,
                         0);
 
-                // Scale the output with respect to the quantization and return it:
-                return Output[0] * Scale / (QuantizationFeature * QuantizationOutput);
+                // The logits are in the units of the quantized outputs, without the scale of the score:
+                const OT one = std::is_floating_point_v<OT> ? 1 : QuantizationFeature * QuantizationOutput;
+
+                return { Dequantize(output[0]), Softmax::Permille(std::array<OT, 3> { output[1], output[2],
+                                                                                       output[3] }, one) };
+            }
+
+            /// \brief Evaluates the score and the win, draw, and loss probabilities of the current accumulator.
+            /// \param colorToMove The color to move.
+            /// \return The score, in the same units as Evaluate, and the win, draw, and loss probabilities.
+            __attribute__((unused)) inline WdlEvaluation EvaluateWdl(const uint8_t colorToMove)
+            {
+                return EvaluateWdl(Accumulators[CurrentAccumulator], colorToMove);
+            }
+
+            /// \brief Evaluates the PSQT (linear) term of an accumulator.
+            /// \param accumulator The accumulator to evaluate, which may be owned by the caller.
+            /// \param colorToMove The color to move.
+            /// \param bucket The PSQT output to evaluate, such as a bucket selected by the material on the board.
+            /// \return The linear term, in the same units as Evaluate.
+            /// \details This function doesn't run the hidden and output layers at all, so it is cheap enough for lazy
+            ///          evaluation or pruning margins. The term is half the difference between the perspectives of the
+            ///          side to move and the other side.
+            [[nodiscard]] __attribute__((unused)) inline OT QuickEvaluate(const Accumulator& accumulator,
+                                                                          const uint8_t colorToMove,
+                                                                          const uint8_t bucket = 0) const
+            {
+                static_assert(PsqtBuckets > 0, "The network has no PSQT outputs.");
+
+                const int32_t us   = colorToMove == 0 ? accumulator.WhitePsqt[bucket] : accumulator.BlackPsqt[bucket];
+                const int32_t them = colorToMove == 0 ? accumulator.BlackPsqt[bucket] : accumulator.WhitePsqt[bucket];
+
+                // Scale the term with respect to the quantization and return it:
+                return (us - them) / 2 * Scale / (QuantizationFeature * QuantizationOutput);
+            }
+
+            /// \brief Evaluates the PSQT (linear) term of the current accumulator.
+            /// \param colorToMove The color to move.
+            /// \param bucket The PSQT output to evaluate, such as a bucket selected by the material on the board.
+            /// \return The linear term, in the same units as Evaluate.
+            __attribute__((unused)) inline OT QuickEvaluate(const uint8_t colorToMove, const uint8_t bucket = 0)
+            {
+                return QuickEvaluate(Accumulators[CurrentAccumulator], colorToMove, bucket);
             }
 
     };
@@ -0,0 +1,283 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_PERSPECTIVEWEIGHTS_H
+#define MANTARAY_PERSPECTIVEWEIGHTS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "InputLayout.h"
+#include "../IO/BinaryFileStream.h"
+#include "../IO/BinaryMemoryStream.h"
+#include "../IO/MarlinflowStream.h"
+#include "../IO/FloatBinaryStream.h"
+
+namespace MantaRay
+{
+
+    /// \brief A process-unique identity of a set of weights.
+    /// \details Every set of weights constructed or copied in the process gets an identity of its own, so evaluations
+    ///          of different weights never share entries of a shared evaluation cache, even if the weights are loaded
+    ///          independently or replace each other at the same address.
+    class WeightIdentity
+    {
+
+        private:
+            uint64_t Value = Next();
+
+            /// \brief The next identity of the process.
+            static uint64_t Next()
+            {
+                static std::atomic<uint64_t> counter = 1;
+                return counter.fetch_add(1, std::memory_order_relaxed);
+            }
+
+        public:
+            WeightIdentity() = default;
+
+            // A copy may be modified independently, so it gets an identity of its own:
+            WeightIdentity(const WeightIdentity&) : Value(Next()) {}
+
+            WeightIdentity& operator=(const WeightIdentity&)
+            {
+                Value = Next();
+                return *this;
+            }
+
+            /// \brief The identity.
+            [[nodiscard]] inline uint64_t Get() const
+            {
+                return Value;
+            }
+
+    };
+
+    /// \brief The weights and biases of a Perspective-accounting Neural Network.
+    /// \tparam T The internal input layer type of the network.
+    /// \tparam InputSize The size of the input layer.
+    /// \tparam HiddenSize The size of the hidden layer.
+    /// \tparam OutputSize The size of the output layer.
+    /// \tparam QuantizationFeature The quantization factor of the input layer, ignored for float weights.
+    /// \tparam QuantizationOutput The quantization factor of the output layer, ignored for float weights.
+    /// \tparam PsqtBuckets The number of PSQT (linear) outputs of every input feature.
+    /// \tparam Layout The layout of the rows of the feature weights.
+    /// \tparam ThreatInputs The number of sparse threat features, weighted by a matrix of their own.
+    /// \details The weights are kept apart from the accumulators so a single, read-only set of weights can be shared
+    ///          by every network instance (typically one per search thread) and replaced as a whole.
+    /// \see MantaRay::PerspectiveNetwork for the Neural Network implementation that uses these weights.
+    template<typename T, uint16_t InputSize, uint16_t HiddenSize, uint16_t OutputSize,
+            T QuantizationFeature, T QuantizationOutput, uint8_t PsqtBuckets = 0,
+            InputLayout Layout = InputLayout::Full, uint16_t ThreatInputs = 0>
+    class PerspectiveWeights
+    {
+
+        static_assert(Layout == InputLayout::Full || InputSize == 768,
+                      "Only the 768 input layout can be compacted.");
+
+        public:
+            /// \brief The number of rows of the feature weights.
+            constexpr static uint16_t Features = Layout == InputLayout::Full ? InputSize : InputFeatures<Layout>::Count;
+
+#ifdef __AVX512BW__
+            alignas(64) std::array<T, Features  * HiddenSize     > FeatureWeight;
+            alignas(64) std::array<T, HiddenSize                 > FeatureBias  ;
+            alignas(64) std::array<T, HiddenSize * 2 * OutputSize> OutputWeight ;
+            alignas(64) std::array<T, OutputSize                 > OutputBias   ;
+            alignas(64) std::array<int32_t, Features * PsqtBuckets > PsqtWeight;
+            alignas(64) std::array<T, ThreatInputs * HiddenSize  > ThreatWeight ;
+#elifdef __AVX2__
+            alignas(32) std::array<T, Features  * HiddenSize     > FeatureWeight;
+            alignas(32) std::array<T, HiddenSize                 > FeatureBias  ;
+            alignas(32) std::array<T, HiddenSize * 2 * OutputSize> OutputWeight ;
+            alignas(32) std::array<T, OutputSize                 > OutputBias   ;
+            alignas(32) std::array<int32_t, Features * PsqtBuckets > PsqtWeight;
+            alignas(32) std::array<T, ThreatInputs * HiddenSize  > ThreatWeight ;
+#else
+            std::array<T, Features  * HiddenSize     > FeatureWeight;
+            std::array<T, HiddenSize                 > FeatureBias  ;
+            std::array<T, HiddenSize * 2 * OutputSize> OutputWeight ;
+            std::array<T, OutputSize                 > OutputBias   ;
+            std::array<int32_t, Features * PsqtBuckets > PsqtWeight;
+            std::array<T, ThreatInputs * HiddenSize  > ThreatWeight ;
+#endif
+
+            /// \brief The process-unique identity of the weights, which keys their evaluations in a shared cache.
+            WeightIdentity Identity;
+
+        private:
+            // Float weights are kept as trained, so they are loaded without quantization:
+            constexpr static size_t KF = std::is_floating_point_v<T> ? 1 : static_cast<size_t>(QuantizationFeature);
+            constexpr static size_t KO = std::is_floating_point_v<T> ? 1 : static_cast<size_t>(QuantizationOutput );
+
+            using FullWeights = PerspectiveWeights<T, InputSize, HiddenSize, OutputSize,
+                                                   QuantizationFeature, QuantizationOutput, PsqtBuckets,
+                                                   InputLayout::Full, ThreatInputs>;
+
+            /// \brief Copy the weights of the full layout, dropping the rows that don't exist in this layout.
+            /// \param full The weights in the full layout.
+            void CompactFrom(const FullWeights& full)
+            {
+                const auto& index = InputFeatures<Layout>::Index;
+
+                for (size_t color = 0; color < 2; color++)
+                    for (size_t piece = 0; piece < 6; piece++)
+                        for (size_t sq = 0; sq < 64; sq++) {
+                            const uint16_t row = index[color][piece][sq];
+                            if (row == InputFeatures<Layout>::Dead) continue;
+
+                            const size_t source = color * 384 + piece * 64 + sq;
+
+                            std::copy_n(full.FeatureWeight.data() + source * HiddenSize, HiddenSize,
+                                        FeatureWeight.data() + row * HiddenSize);
+                            std::copy_n(full.PsqtWeight.data() + source * PsqtBuckets, PsqtBuckets,
+                                        PsqtWeight.data() + row * PsqtBuckets);
+                        }
+
+                FeatureBias  = full.FeatureBias ;
+                OutputWeight = full.OutputWeight;
+                OutputBias   = full.OutputBias  ;
+                ThreatWeight = full.ThreatWeight;
+            }
+
+        public:
+            /// \brief Constructs new PerspectiveWeights.
+            /// \details This constructor leaves the weights and biases undefined.
+            __attribute__((unused)) PerspectiveWeights() = default;
+
+            /// \brief Constructs new PerspectiveWeights.
+            /// \param full The weights in the full layout.
+            /// \details This constructor compacts the weights into this layout.
+            template<InputLayout Source, typename = std::enable_if_t<Source == InputLayout::Full &&
+                                                                     Layout != InputLayout::Full>>
+            __attribute__((unused)) explicit PerspectiveWeights(
+                    const PerspectiveWeights<T, InputSize, HiddenSize, OutputSize,
+                                             QuantizationFeature, QuantizationOutput, PsqtBuckets, Source,
+                                             ThreatInputs>& full)
+            {
+                CompactFrom(full);
+            }
+
+            /// \brief Constructs new PerspectiveWeights.
+            /// \param stream The binary file stream to read the weights from.
+            /// \details This constructor initializes the weights and biases read from the stream.
+            __attribute__((unused)) explicit PerspectiveWeights(BinaryFileStream &stream)
+            {
+                stream.ReadArray(FeatureWeight);
+                stream.ReadArray(FeatureBias  );
+                stream.ReadArray(OutputWeight );
+                stream.ReadArray(OutputBias   );
+
+                // The PSQT weights and then the threat weights follow the network, if there are any:
+                if constexpr (PsqtBuckets  > 0) stream.ReadArray(PsqtWeight  );
+                if constexpr (ThreatInputs > 0) stream.ReadArray(ThreatWeight);
+            }
+
+            /// \brief Constructs new PerspectiveWeights.
+            /// \param stream The binary memory stream to read the weights from.
+            /// \details This constructor initializes the weights and biases read from the stream.
+            __attribute__((unused)) explicit PerspectiveWeights(BinaryMemoryStream &stream)
+            {
+                stream.ReadArray(FeatureWeight);
+                stream.ReadArray(FeatureBias  );
+                stream.ReadArray(OutputWeight );
+                stream.ReadArray(OutputBias   );
+
+                // The PSQT weights and then the threat weights follow the network, if there are any:
+                if constexpr (PsqtBuckets  > 0) stream.ReadArray(PsqtWeight  );
+                if constexpr (ThreatInputs > 0) stream.ReadArray(ThreatWeight);
+            }
+
+            /// \brief Constructs new PerspectiveWeights.
+            /// \param stream The Marlinflow JSON stream to read the weights from.
+            /// \details This constructor initializes the weights and biases read from the stream. Internally, this
+            ///          constructor also quantizes the weights and biases, unless they are floats. It also permutes the
+            ///          weights to ensure better performance with respect to the cache. The PSQT weights are read
+            ///          from the optional "psqt.weight" key, shaped [PsqtBuckets][InputSize], and are left zeroed if it
+            ///          is missing. The threat weights are read from the "threat.weight" key, shaped like
+            ///          "ft.weight" with ThreatInputs columns.
+            ///          Marlinflow networks always use the full layout, which is compacted after loading.
+            /// \throws std::runtime_error If the file is malformed or doesn't match the shape of the network.
+            __attribute__((unused)) explicit PerspectiveWeights(MarlinflowStream &stream)
+            {
+                if constexpr (Layout != InputLayout::Full) {
+                    CompactFrom(*std::make_unique<FullWeights>(stream));
+                } else {
+                    stream.Bind2DArray("ft.weight" , FeatureWeight, HiddenSize    , KF, true );
+                    stream.Bind2DArray("out.weight", OutputWeight , HiddenSize * 2, KO, false);
+
+                    stream.BindArray("ft.bias" , FeatureBias, KF     );
+                    stream.BindArray("out.bias", OutputBias , KF * KO);
+
+                    // The PSQT weights are optional, as networks trained without them can still be loaded:
+                    PsqtWeight.fill(0);
+                    if constexpr (PsqtBuckets > 0)
+                        stream.Bind2DArray("psqt.weight", PsqtWeight, PsqtBuckets, KF * KO, true, false);
+
+                    if constexpr (ThreatInputs > 0)
+                        stream.Bind2DArray("threat.weight", ThreatWeight, HiddenSize, KF, true);
+
+                    // Stream the file into the bound arrays in a single pass:
+                    if (!stream.Parse()) throw std::runtime_error("The Marlinflow network is malformed or mis-shaped.");
+                }
+            }
+
+            /// \brief Constructs new PerspectiveWeights.
+            /// \param stream The float32 tensor stream to read the weights from.
+            /// \details This constructor initializes the weights and biases read from the stream, which must contain
+            ///          the feature weights, feature bias, output weights and output bias as little-endian float32
+            ///          tensors, in this order and shaped like their Marlinflow counterparts, followed by the PSQT
+            ///          and threat weights if the network has any. The weights and biases are quantized (unless they
+            ///          are floats) and permuted while they are streamed. The tensors always use the full layout,
+            ///          which is compacted after loading.
+            /// \throws std::runtime_error If the file ends before all tensors were read.
+            __attribute__((unused)) explicit PerspectiveWeights(FloatBinaryStream &stream)
+            {
+                if constexpr (Layout != InputLayout::Full) {
+                    CompactFrom(*std::make_unique<FullWeights>(stream));
+                } else {
+                    // The tensors are read in the order they are stored in:
+                    stream.Read2DArray(FeatureWeight, HiddenSize, KF     , true );
+                    stream.ReadArray  (FeatureBias  ,             KF            );
+                    stream.Read2DArray(OutputWeight , OutputSize, KO     , false);
+                    stream.ReadArray  (OutputBias   ,             KF * KO       );
+
+                    // The PSQT weights and then the threat weights follow the network, if there are any:
+                    if constexpr (PsqtBuckets > 0)
+                        stream.Read2DArray(PsqtWeight, PsqtBuckets, KF * KO, true);
+                    if constexpr (ThreatInputs > 0)
+                        stream.Read2DArray(ThreatWeight, HiddenSize, KF, true);
+
+                    if (!stream.Good())
+                        throw std::runtime_error("The float32 network ended before all tensors were read.");
+                }
+            }
+
+            /// \brief Writes the weights to a binary file stream.
+            /// \param stream The binary file stream to write the weights to.
+            /// \details This function writes the weights and biases to the stream.
+            __attribute__((unused)) void WriteTo(BinaryFileStream &stream) const
+            {
+                stream.WriteMode();
+
+                stream.WriteArray(FeatureWeight);
+                stream.WriteArray(FeatureBias  );
+                stream.WriteArray(OutputWeight );
+                stream.WriteArray(OutputBias   );
+
+                if constexpr (PsqtBuckets  > 0) stream.WriteArray(PsqtWeight  );
+                if constexpr (ThreatInputs > 0) stream.WriteArray(ThreatWeight);
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_PERSPECTIVEWEIGHTS_H
@@ -0,0 +1,193 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_POSITION_H
+#define MANTARAY_POSITION_H
+
+#include <bit>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <string_view>
+
+#include "InputLayout.h"
+
+namespace MantaRay
+{
+
+    /// \brief A chess position as the bitboards of its pieces.
+    /// \details There is a bitboard for every color and piece, indexed by color * 6 + piece, with the pieces ordered
+    ///          pawn, knight, bishop, rook, queen and king, and white as color 0. Bit n of a bitboard is the square n,
+    ///          counting from A1 to H8. This matches the rows of MantaRay::InputFeatures, which lets the features of
+    ///          both perspectives be extracted straight from the bitboards.
+    class Position
+    {
+
+        public:
+            /// \brief The largest number of pieces a position can hold, one on every square.
+            constexpr static size_t MaxPieces = 64;
+
+            std::array<uint64_t, 12> Bitboards {};
+
+            uint8_t ColorToMove = 0;
+
+            /// \brief Constructs an empty position.
+            Position() = default;
+
+            /// \brief Constructs a position from the bitboards of its pieces.
+            /// \param bitboards The bitboard of every color and piece, indexed by color * 6 + piece.
+            /// \param colorToMove The color to move.
+            __attribute__((unused)) Position(const std::array<uint64_t, 12>& bitboards, const uint8_t colorToMove) :
+            Bitboards(bitboards), ColorToMove(colorToMove) {}
+
+            /// \brief Parse the piece placement and the color to move of a FEN string.
+            /// \param fen The FEN string.
+            /// \param position The parsed position.
+            /// \return Whether the FEN string could be parsed into a valid position.
+            /// \details The piece placement must have 8 ranks of exactly 8 files, and must be followed by a single
+            ///          space and a 'w' or 'b' token. Any fields after it are ignored.
+            /// \see MantaRay::Position::Valid for the positions considered valid.
+            __attribute__((unused)) static bool FromFen(const std::string_view fen, Position& position)
+            {
+                constexpr std::string_view Pieces = "pnbrqk";
+
+                position = Position();
+
+                size_t i = 0;
+                int rank = 7;
+                int file = 0;
+                for (; i < fen.size() && fen[i] != ' '; i++) {
+                    const char c = fen[i];
+
+                    if (c == '/') {
+                        // Every rank must be complete before the next one starts:
+                        if (file != 8 || rank == 0) return false;
+
+                        rank--;
+                        file = 0;
+                    } else if (c >= '1' && c <= '8') {
+                        file += c - '0';
+                        if (file > 8) return false;
+                    } else {
+                        const size_t piece = Pieces.find(static_cast<char>(c | 0x20));
+                        if (piece == std::string_view::npos || file > 7) return false;
+
+                        const size_t color = c >= 'a' ? 1 : 0;
+                        position.Bitboards[color * 6 + piece] |= 1ULL << (rank * 8 + file++);
+                    }
+                }
+
+                // The placement must cover all 8 ranks of 8 files:
+                if (rank != 0 || file != 8) return false;
+
+                // The placement must be followed by a single space and exactly one 'w' or 'b' token:
+                if (i + 1 >= fen.size() || (fen[i + 1] != 'w' && fen[i + 1] != 'b')) return false;
+                if (i + 2 < fen.size() && fen[i + 2] != ' ') return false;
+
+                position.ColorToMove = fen[i + 1] == 'b' ? 1 : 0;
+                return position.Valid();
+            }
+
+            /// \brief The bitboard of every occupied square.
+            [[nodiscard]] __attribute__((unused)) uint64_t Occupied() const
+            {
+                uint64_t occupied = 0;
+                for (const uint64_t bitboard : Bitboards) occupied |= bitboard;
+                return occupied;
+            }
+
+            /// \brief Whether the position can be evaluated.
+            /// \details A position is valid when no two pieces share a square, no pawn stands on the first or last
+            ///          rank, and the color to move is white or black. Kings aren't required.
+            [[nodiscard]] __attribute__((unused)) bool Valid() const
+            {
+                constexpr uint64_t BackRanks = 0xFF000000000000FFULL;
+
+                size_t pieces = 0;
+                for (const uint64_t bitboard : Bitboards) pieces += std::popcount(bitboard);
+
+                return pieces == static_cast<size_t>(std::popcount(Occupied())) && ColorToMove < 2 &&
+                       ((Bitboards[0] | Bitboards[6]) & BackRanks) == 0;
+            }
+
+            /// \brief Extract the input features of both perspectives.
+            /// \tparam Layout The input layout of the network.
+            /// \param white The rows of the features with respect to white, at least MaxPieces long.
+            /// \param black The rows of the features with respect to black, at least MaxPieces long.
+            /// \return The number of features of every perspective.
+            /// \details The rows of a color and piece are consecutive over the squares it can stand on, so the row of
+            ///          a feature is the row of the square zero plus the square, and the squares are popped off the
+            ///          bitboards with a trailing zero count. Black sees the board flipped vertically, which is a byte
+            ///          swap of the bitboards. The two perspectives list the features in different orders.
+            template<InputLayout Layout>
+            size_t Features(uint16_t* white, uint16_t* black) const
+            {
+                static_assert(Consecutive<Layout>(), "The rows of a color and piece must be consecutive.");
+                assert(Valid());
+
+                size_t count = 0;
+                for (uint8_t color = 0; color < 2; color++)
+                    for (uint8_t piece = 0; piece < 6; piece++) {
+                        const uint64_t bitboard = Bitboards[color * 6 + piece];
+
+                        const int32_t whiteRow = Rows<Layout>[color    ][piece];
+                        const int32_t blackRow = Rows<Layout>[color ^ 1][piece];
+
+                        size_t w = count;
+                        for (uint64_t b = bitboard; b != 0; b &= b - 1)
+                            white[w++] = static_cast<uint16_t>(whiteRow + std::countr_zero(b));
+
+                        for (uint64_t b = __builtin_bswap64(bitboard); b != 0; b &= b - 1)
+                            black[count++] = static_cast<uint16_t>(blackRow + std::countr_zero(b));
+                    }
+
+                return count;
+            }
+
+        private:
+            using RowTable = std::array<std::array<int32_t, 6>, 2>;
+
+            /// \brief Build the row of the square zero of every color and piece, which may be negative when the
+            ///        piece can't stand on the first squares.
+            template<InputLayout Layout>
+            constexpr static RowTable BuildRows()
+            {
+                constexpr auto& Index = InputFeatures<Layout>::Index;
+
+                RowTable rows {};
+                for (uint8_t color = 0; color < 2; color++)
+                    for (uint8_t piece = 0; piece < 6; piece++) {
+                        // The square A2 can hold any piece in every layout:
+                        rows[color][piece] = Index[color][piece][8] - 8;
+                    }
+
+                return rows;
+            }
+
+            /// \brief Whether the rows of every color and piece are consecutive over the squares it can stand on.
+            template<InputLayout Layout>
+            constexpr static bool Consecutive()
+            {
+                constexpr auto& Index = InputFeatures<Layout>::Index;
+                constexpr RowTable Rows = BuildRows<Layout>();
+
+                for (uint8_t color = 0; color < 2; color++)
+                    for (uint8_t piece = 0; piece < 6; piece++)
+                        for (uint8_t sq = 0; sq < 64; sq++) {
+                            const uint16_t row = Index[color][piece][sq];
+                            if (row != InputFeatures<Layout>::Dead && row != Rows[color][piece] + sq) return false;
+                        }
+
+                return true;
+            }
+
+            template<InputLayout Layout>
+            constexpr static RowTable Rows = BuildRows<Layout>();
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_POSITION_H
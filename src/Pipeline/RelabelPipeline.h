@@ -0,0 +1,273 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_RELABELPIPELINE_H
+#define MANTARAY_RELABELPIPELINE_H
+
+#include <span>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cctype>
+#include <cstdint>
+#include <utility>
+#include <semaphore>
+#include <algorithm>
+#include <string_view>
+
+#include "WorkStealingPool.h"
+#include "../Perspective/Position.h"
+#include "../IO/LineWriter.h"
+#include "../IO/MappedLineReader.h"
+#include "../Memory/AlignedAllocator.h"
+
+namespace MantaRay
+{
+
+    /// \brief The options of a MantaRay::RelabelPipeline.
+    struct RelabelOptions
+    {
+
+        /// \brief The number of worker threads.
+        size_t Threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+        /// \brief The approximate number of bytes of input handed to a worker at once.
+        size_t ChunkSize = 1 << 20;
+
+        /// \brief The number of positions refreshed and evaluated together by a worker.
+        size_t BatchSize = 256;
+
+        /// \brief Whether the output keeps the order of the input.
+        bool Ordered = true;
+
+    };
+
+    /// \brief The statistics of a run of a MantaRay::RelabelPipeline.
+    struct RelabelStatistics
+    {
+
+        size_t Positions = 0;
+        size_t Skipped   = 0;
+        size_t Threads   = 0;
+        double Seconds   = 0;
+
+        /// \brief The number of positions relabeled per second.
+        [[nodiscard]] __attribute__((unused)) double PositionsPerSecond() const
+        {
+            return Seconds > 0 ? static_cast<double>(Positions) / Seconds : 0;
+        }
+
+        /// \brief The number of positions relabeled per second by every worker thread.
+        [[nodiscard]] __attribute__((unused)) double PositionsPerSecondPerCore() const
+        {
+            return Threads > 0 ? PositionsPerSecond() / static_cast<double>(Threads) : 0;
+        }
+
+    };
+
+    /// \brief A multi-threaded pipeline rescoring a dataset of positions with a network.
+    /// \tparam Network The network to score with, such as MantaRay::PerspectiveNetwork.
+    /// \details The dataset is a text file with a position on every line, formatted as "<FEN> | <score> | <rest>"
+    ///          (such as the result of the game), where the score and the rest are optional. The file is memory-mapped
+    ///          and handed out in chunks of whole lines to a work-stealing pool. Every worker owns its accumulators and
+    ///          refreshes and evaluates its positions in batches, and the relabeled chunks are streamed to the output
+    ///          file, either in input order or as soon as they are done. Every output line keeps the FEN and the rest
+    ///          of its input line, with the score replaced by the evaluation of the network from white's point of
+    ///          view. Lines that can't be parsed into a valid position are skipped.
+    template<typename Network>
+    class RelabelPipeline
+    {
+
+        private:
+            using Accumulator = typename Network::Accumulator;
+
+            using OutputType = decltype(std::declval<const Network&>().Evaluate(std::declval<const Accumulator&>(),
+                                                                                0));
+
+            /// \brief The state owned by a worker thread.
+            struct Worker
+            {
+
+                std::vector<Accumulator, AlignedAllocator<Accumulator>> Accumulators;
+                std::vector<const Accumulator*> Pointers;
+
+                std::vector<Position        > Positions;
+                std::vector<std::string_view> Lines;
+                std::vector<uint8_t         > ColorsToMove;
+                std::vector<OutputType      > Scores;
+
+                size_t Relabeled = 0;
+                size_t Skipped   = 0;
+
+            };
+
+            const Network* Net;
+
+            RelabelOptions Options;
+
+            /// \brief Trim the whitespace around a string.
+            static std::string_view Trim(std::string_view text)
+            {
+                while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) text.remove_prefix(1);
+                while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back ()))) text.remove_suffix(1);
+                return text;
+            }
+
+            /// \brief Refresh, evaluate and write out the batch of a worker.
+            /// \param worker The worker.
+            /// \param output The relabeled lines, which are appended to.
+            void Flush(Worker& worker, std::string& output) const
+            {
+                const size_t count = worker.Lines.size();
+                if (count == 0) return;
+
+                for (size_t i = 0; i < count; i++) worker.ColorsToMove[i] = worker.Positions[i].ColorToMove;
+
+                Net->RefreshBatch(std::span<const Position>(worker.Positions),
+                                  std::span(worker.Accumulators.data(), count));
+                Net->EvaluateBatch(std::span(worker.Pointers.data(), count),
+                                   std::span(worker.ColorsToMove.data(), count),
+                                   std::span(worker.Scores.data(), count));
+
+                for (size_t i = 0; i < count; i++) {
+                    const std::string_view line = worker.Lines[i];
+
+                    // Scores are stored from white's point of view:
+                    const OutputType score = worker.ColorsToMove[i] == 0 ? worker.Scores[i] : -worker.Scores[i];
+
+                    const size_t fenEnd = line.find('|');
+                    output += Trim(line.substr(0, fenEnd));
+                    output += " | ";
+                    output += std::to_string(score);
+
+                    // Keep everything following the score as it is:
+                    if (fenEnd != std::string_view::npos) {
+                        const size_t scoreEnd = line.find('|', fenEnd + 1);
+                        if (scoreEnd != std::string_view::npos) {
+                            output += " | ";
+                            output += Trim(line.substr(scoreEnd + 1));
+                        }
+                    }
+
+                    output += '\n';
+                }
+
+                worker.Relabeled += count;
+
+                worker.Positions.clear();
+                worker.Lines    .clear();
+            }
+
+            /// \brief Relabel a chunk of lines.
+            /// \param worker The worker relabeling the chunk.
+            /// \param lines The chunk of lines.
+            /// \return The relabeled lines.
+            std::string Process(Worker& worker, std::string_view lines) const
+            {
+                std::string output;
+                output.reserve(lines.size() + lines.size() / 8);
+
+                while (!lines.empty()) {
+                    const size_t end = lines.find('\n');
+                    const std::string_view line = Trim(lines.substr(0, end));
+                    lines.remove_prefix(end == std::string_view::npos ? lines.size() : end + 1);
+
+                    if (line.empty()) continue;
+
+                    Position position;
+                    if (!Position::FromFen(line.substr(0, line.find('|')), position)) {
+                        worker.Skipped++;
+                        continue;
+                    }
+
+                    worker.Positions.push_back(position);
+                    worker.Lines    .push_back(line);
+
+                    if (worker.Lines.size() == Options.BatchSize) Flush(worker, output);
+                }
+
+                Flush(worker, output);
+                return output;
+            }
+
+        public:
+            /// \brief Constructs a new RelabelPipeline.
+            /// \param network The network to score with, which must outlive the pipeline.
+            /// \param options The options of the pipeline.
+            __attribute__((unused)) explicit RelabelPipeline(const Network& network,
+                                                             const RelabelOptions options = RelabelOptions()) :
+            Net(&network), Options(options)
+            {
+                Options.Threads   = std::max<size_t>(Options.Threads  , 1);
+                Options.BatchSize = std::max<size_t>(Options.BatchSize, 1);
+            }
+
+            /// \brief Relabel a dataset.
+            /// \param input The path to the dataset.
+            /// \param output The path to write the relabeled dataset to.
+            /// \param statistics The statistics of the run.
+            /// \return Whether the dataset could be read and the relabeled dataset written.
+            __attribute__((unused)) bool Run(const std::string& input, const std::string& output,
+                                             RelabelStatistics& statistics) const
+            {
+                const auto start = std::chrono::steady_clock::now();
+
+                MappedLineReader reader(input);
+                if (!reader.Good()) return false;
+
+                LineWriter writer(output, Options.Ordered);
+                if (!writer.Good()) return false;
+
+                // Every worker owns its batch of accumulators:
+                std::vector<Worker> workers(Options.Threads);
+                for (Worker& worker : workers) {
+                    worker.Accumulators.resize(Options.BatchSize);
+                    worker.ColorsToMove.resize(Options.BatchSize);
+                    worker.Scores      .resize(Options.BatchSize);
+
+                    for (const Accumulator& accumulator : worker.Accumulators) worker.Pointers.push_back(&accumulator);
+                }
+
+                {
+                    WorkStealingPool pool(Options.Threads);
+
+                    // Bound the chunks that are read but not written out yet, including the chunks an ordered writer
+                    // holds back, so a slow chunk can't make the writer buffer the rest of the input:
+                    std::counting_semaphore<> slots(static_cast<std::ptrdiff_t>(Options.Threads * 4));
+
+                    MappedLineReader::Chunk chunk {};
+                    while (reader.Next(Options.ChunkSize, chunk)) {
+                        slots.acquire();
+
+                        pool.Submit([this, &workers, &writer, &slots, chunk](const size_t worker) {
+                            // A slot is only freed once its chunk left the writer, which may be on a later call:
+                            const size_t written = writer.Write(chunk.Index, Process(workers[worker], chunk.Lines));
+                            if (written > 0) slots.release(static_cast<std::ptrdiff_t>(written));
+                        });
+                    }
+
+                    pool.Wait();
+                }
+
+                writer.Flush();
+
+                statistics = RelabelStatistics();
+                for (const Worker& worker : workers) {
+                    statistics.Positions += worker.Relabeled;
+                    statistics.Skipped   += worker.Skipped  ;
+                }
+
+                statistics.Threads = Options.Threads;
+                statistics.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                return writer.Good();
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_RELABELPIPELINE_H
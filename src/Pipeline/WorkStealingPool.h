@@ -0,0 +1,170 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_WORKSTEALINGPOOL_H
+#define MANTARAY_WORKSTEALINGPOOL_H
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include <condition_variable>
+
+namespace MantaRay
+{
+
+    /// \brief A pool of worker threads that steal work from each other.
+    /// \details Every worker owns a queue of tasks. Submitted tasks are spread over the queues round-robin, and a
+    ///          worker takes tasks from the back of its own queue, stealing from the front of the other queues only
+    ///          once its own runs dry, so workers rarely contend on the same queue. Tasks receive the index of the
+    ///          worker running them, which lets them use state owned by that worker (such as its accumulators)
+    ///          without any synchronization.
+    class WorkStealingPool
+    {
+
+        public:
+            using Task = std::function<void(size_t worker)>;
+
+        private:
+            struct Queue
+            {
+                std::mutex       Lock;
+                std::deque<Task> Tasks;
+            };
+
+            std::vector<std::unique_ptr<Queue>> Queues;
+            std::vector<std::thread>            Workers;
+
+            std::mutex              Lock;
+            std::condition_variable Available;
+            std::condition_variable Idle;
+
+            // The number of tasks waiting in a queue, and the number of tasks not yet finished:
+            size_t Queued  = 0;
+            size_t Pending = 0;
+
+            bool Stopping = false;
+
+            std::atomic<size_t> NextQueue = 0;
+
+            /// \brief Take a task, from the worker's own queue if possible, or from another queue otherwise.
+            /// \param worker The index of the worker.
+            /// \param task The task taken.
+            /// \return Whether a task was taken.
+            bool Take(const size_t worker, Task& task)
+            {
+                for (size_t i = 0; i < Queues.size(); i++) {
+                    Queue& queue = *Queues[(worker + i) % Queues.size()];
+
+                    std::lock_guard<std::mutex> guard(queue.Lock);
+                    if (queue.Tasks.empty()) continue;
+
+                    // Own tasks are taken newest first, while stolen tasks are taken oldest first:
+                    if (i == 0) {
+                        task = std::move(queue.Tasks.back());
+                        queue.Tasks.pop_back();
+                    } else {
+                        task = std::move(queue.Tasks.front());
+                        queue.Tasks.pop_front();
+                    }
+
+                    return true;
+                }
+
+                return false;
+            }
+
+            /// \brief The loop run by every worker.
+            /// \param worker The index of the worker.
+            void Work(const size_t worker)
+            {
+                while (true) {
+                    Task task;
+
+                    if (Take(worker, task)) {
+                        {
+                            std::lock_guard<std::mutex> guard(Lock);
+                            Queued--;
+                        }
+
+                        task(worker);
+
+                        std::lock_guard<std::mutex> guard(Lock);
+                        if (--Pending == 0) Idle.notify_all();
+                        continue;
+                    }
+
+                    std::unique_lock<std::mutex> guard(Lock);
+                    Available.wait(guard, [this] { return Stopping || Queued > 0; });
+
+                    if (Stopping && Queued == 0) return;
+                }
+            }
+
+        public:
+            /// \brief Constructs a new WorkStealingPool.
+            /// \param threads The number of worker threads.
+            __attribute__((unused)) explicit WorkStealingPool(const size_t threads)
+            {
+                for (size_t i = 0; i < std::max<size_t>(threads, 1); i++) Queues.push_back(std::make_unique<Queue>());
+                for (size_t i = 0; i < Queues.size(); i++) Workers.emplace_back([this, i] { Work(i); });
+            }
+
+            WorkStealingPool(const WorkStealingPool&) = delete;
+            WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+            /// \brief Finishes every submitted task and joins the workers.
+            ~WorkStealingPool()
+            {
+                {
+                    std::lock_guard<std::mutex> guard(Lock);
+                    Stopping = true;
+                }
+
+                Available.notify_all();
+                for (std::thread& worker : Workers) worker.join();
+            }
+
+            /// \brief The number of worker threads.
+            [[nodiscard]] __attribute__((unused)) size_t Threads() const
+            {
+                return Workers.size();
+            }
+
+            /// \brief Submit a task.
+            /// \param task The task, which receives the index of the worker running it.
+            __attribute__((unused)) void Submit(Task task)
+            {
+                Queue& queue = *Queues[NextQueue.fetch_add(1, std::memory_order_relaxed) % Queues.size()];
+
+                {
+                    // The task is counted before any worker can take it:
+                    std::lock_guard<std::mutex> guard(Lock);
+                    Queued++;
+                    Pending++;
+
+                    std::lock_guard<std::mutex> queueGuard(queue.Lock);
+                    queue.Tasks.push_back(std::move(task));
+                }
+
+                Available.notify_one();
+            }
+
+            /// \brief Wait until every submitted task finished.
+            __attribute__((unused)) void Wait()
+            {
+                std::unique_lock<std::mutex> guard(Lock);
+                Idle.wait(guard, [this] { return Pending == 0; });
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_WORKSTEALINGPOOL_H
@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_QUANTIZER_H
+#define MANTARAY_QUANTIZER_H
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+
+namespace MantaRay
+{
+
+    /// \brief The rounding used when quantizing a value.
+    enum class QuantizationRounding
+    {
+
+        /// \brief Round towards zero.
+        /// \details This is the rounding used by the network loaders, matching a plain integer cast.
+        Truncate __attribute__((unused)),
+
+        /// \brief Round to the nearest integer, with halfway cases rounded away from zero.
+        Nearest  __attribute__((unused))
+
+    };
+
+    /// \brief A quantizer that keeps statistics about the values it has quantized.
+    /// \tparam T The quantized type.
+    /// \details This class quantizes floating-point values into the provided integer type using the configured
+    ///          rounding. Values that don't fit into the type are saturated to its range. The number of saturated
+    ///          values and the largest rounding error are recorded, which is useful when converting networks offline.
+    template<typename T>
+    class Quantizer
+    {
+
+        static_assert(std::is_integral_v<T>, "Only integral types can be quantized into.");
+
+        private:
+            QuantizationRounding Rounding;
+
+            size_t QuantizedCount = 0;
+            size_t SaturatedCount = 0;
+            double LargestError   = 0;
+
+        public:
+            /// \brief Constructs a new Quantizer.
+            /// \param rounding The rounding to use.
+            __attribute__((unused)) explicit Quantizer(const QuantizationRounding rounding) : Rounding(rounding) {}
+
+            /// \brief Quantize a value.
+            /// \param value The value to quantize.
+            /// \param K The Quantization factor.
+            /// \return The quantized value, saturated to the range of T.
+            __attribute__((unused)) T Quantize(const double value, const double K)
+            {
+                constexpr double Minimum = std::numeric_limits<T>::min();
+                constexpr double Maximum = std::numeric_limits<T>::max();
+
+                const double scaled  = value * K;
+                const double rounded = Rounding == QuantizationRounding::Nearest ? std::round(scaled) :
+                                                                                   std::trunc(scaled);
+
+                // Saturate the rounded value to the range of the quantized type:
+                const double saturated = std::clamp(rounded, Minimum, Maximum);
+
+                QuantizedCount++;
+                if (saturated != rounded) SaturatedCount++;
+                else LargestError = std::max(LargestError, std::abs(scaled - rounded));
+
+                return static_cast<T>(saturated);
+            }
+
+            /// \brief The number of values quantized so far.
+            [[nodiscard]] __attribute__((unused)) size_t Count() const { return QuantizedCount; }
+
+            /// \brief The number of values that didn't fit into T and were saturated.
+            [[nodiscard]] __attribute__((unused)) size_t Saturated() const { return SaturatedCount; }
+
+            /// \brief The largest rounding error of the values that weren't saturated, in quantized units.
+            [[nodiscard]] __attribute__((unused)) double MaxError() const { return LargestError; }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_QUANTIZER_H
@@ -0,0 +1,125 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#include "Perspective/PerspectiveNNUE.h"
+#include "Activation/ClippedReLU.h"
+#include "Pipeline/RelabelPipeline.h"
+#include "CommandLine.h"
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <exception>
+#include <stdexcept>
+
+// Offline tool rescoring a dataset of FEN lines with a network.
+
+using Network = MantaRay::PerspectiveNetwork<int16_t, int32_t, MantaRay::ClippedReLU<int16_t, 0, 255>,
+                                             768, 256, 1, 512, 400, 255, 64>;
+
+struct RelabelRunnerOptions
+{
+
+    std::string Network;
+    std::string Input;
+    std::string Output;
+
+    bool MarlinflowNetwork = false;
+
+    MantaRay::RelabelOptions Pipeline;
+
+};
+
+void PrintUsage()
+{
+    std::cout << "Usage: MantaRayRelabel --network <network> --input <data> --output <data> [options]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --format <format>        Network format: binary (default) or marlinflow."      << std::endl;
+    std::cout << "  --threads <count>        Worker threads (default: all cores)."                 << std::endl;
+    std::cout << "  --batch <size>           Positions evaluated together (default 256)."          << std::endl;
+    std::cout << "  --chunk <kilobytes>      Input handed to a worker at once (default 1024)."     << std::endl;
+    std::cout << "  --order <order>          Output order: ordered (default) or unordered."        << std::endl;
+}
+
+bool ParseOptions(const int argc, char** argv, RelabelRunnerOptions& options)
+{
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+
+        // Every option takes exactly one value:
+        if (i + 1 >= argc) return false;
+        const std::string value = argv[++i];
+
+        size_t chunk;
+        if      (arg == "--network") options.Network = value;
+        else if (arg == "--input"  ) options.Input   = value;
+        else if (arg == "--output" ) options.Output  = value;
+        else if (arg == "--threads") {
+            if (!MantaRay::CommandLine::ParseCount(value, options.Pipeline.Threads  , 1, 1 << 12)) return false;
+        }
+        else if (arg == "--batch"  ) {
+            if (!MantaRay::CommandLine::ParseCount(value, options.Pipeline.BatchSize, 1, 1 << 20)) return false;
+        }
+        else if (arg == "--chunk"  ) {
+            if (!MantaRay::CommandLine::ParseCount(value, chunk                     , 1, 1 << 20)) return false;
+            options.Pipeline.ChunkSize = chunk * 1024;
+        }
+        else if (arg == "--format" ) {
+            if      (value == "binary"    ) options.MarlinflowNetwork = false;
+            else if (value == "marlinflow") options.MarlinflowNetwork = true ;
+            else return false;
+        }
+        else if (arg == "--order") {
+            if      (value == "ordered"  ) options.Pipeline.Ordered = true ;
+            else if (value == "unordered") options.Pipeline.Ordered = false;
+            else return false;
+        }
+        else return false;
+    }
+
+    return !options.Network.empty() && !options.Input.empty() && !options.Output.empty();
+}
+
+int main(const int argc, char** argv)
+{
+    RelabelRunnerOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::unique_ptr<Network> network;
+    try {
+        if (options.MarlinflowNetwork) {
+            MantaRay::MarlinflowStream stream(options.Network);
+            network = std::make_unique<Network>(stream);
+        } else {
+            MantaRay::BinaryFileStream stream(options.Network);
+            network = std::make_unique<Network>(stream);
+
+            // Binary networks are read as is, so a missing or mis-shaped file has to be caught here:
+            if (!stream.Good() || !stream.Finished())
+                throw std::runtime_error("The file is missing or doesn't match the shape of the network.");
+        }
+    } catch (const std::exception& exception) {
+        std::cerr << "Failed to load " << options.Network << ": " << exception.what() << std::endl;
+        return 1;
+    }
+
+    const MantaRay::RelabelPipeline<Network> pipeline(*network, options.Pipeline);
+
+    MantaRay::RelabelStatistics statistics;
+    if (!pipeline.Run(options.Input, options.Output, statistics)) {
+        std::cerr << "Failed to relabel " << options.Input << " into " << options.Output << "." << std::endl;
+        return 1;
+    }
+
+    std::cout << "Relabeled " << statistics.Positions << " positions in " << statistics.Seconds << "s." << std::endl;
+    std::cout << " | Skipped lines        : " << statistics.Skipped                        << std::endl;
+    std::cout << " | Threads              : " << statistics.Threads                        << std::endl;
+    std::cout << " | Positions per second : " << statistics.PositionsPerSecond()         << std::endl;
+    std::cout << " | Per core             : " << statistics.PositionsPerSecondPerCore()  << std::endl;
+    return 0;
+}
@@ -7,6 +7,13 @@
 #define MANTARAY_SIMD_H
 
 #include <array>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <span>
+#include <type_traits>
+
+#include "AccumulatorLayout.h"
 
 #ifdef __AVX512BW__
 #include "Backend/Avx512.h"
@@ -22,446 +29,1012 @@ namespace MantaRay
     class SIMD
     {
 
+        private:
+            /// \brief The number of vector registers of the compiled instruction set.
+#ifdef __AVX512BW__
+            constexpr static size_t Registers = 32;
+#elifdef __AVX2__
+            constexpr static size_t Registers = 16;
+#else
+            constexpr static size_t Registers = 1;
+#endif
+
+            /// \brief The number of registers of a tile of accumulator values kept in registers.
+            /// \param size The number of registers a perspective spans.
+            /// \return The largest divisor of the size that leaves a few registers for the rows being loaded, so the
+            ///         tiles cover the perspective exactly.
+            [[nodiscard]] constexpr static size_t TileRegisters(const size_t size)
+            {
+                size_t tile = std::min(size, Registers > 4 ? Registers - 4 : 1);
+                while (size % tile != 0) tile--;
+
+                return tile;
+            }
+
+#ifdef __AVX512BW__
+            /// \brief Multiply the input by the weights and add the products to the sum.
+            /// \tparam T The type of the input and weights.
+            /// \tparam OT The type of the sum.
+            /// \param sum The sum.
+            /// \param input The input register.
+            /// \param weight The weight register.
+            /// \return The sum with the products added.
+            /// \details Integers multiply into pairs of wider values summed up adjacently, while floats are multiplied
+            ///          and added in a single fused instruction.
+            template<typename T, typename OT>
+            static inline Vec512<OT> MultiplyAndAccumulate(const Vec512<OT>& sum, const Vec512<T>& input,
+                                                           const Vec512<T>& weight)
+            {
+                if constexpr (std::is_floating_point_v<T>) return Avx512<T>::MultiplyAdd(input, weight, sum);
+                else return Avx512<OT>::Add(sum, Avx512<T>::MultiplyAndAddAdjacent(input, weight));
+            }
+#elifdef __AVX2__
+            /// \brief Multiply the input by the weights and add the products to the sum.
+            /// \see MantaRay::SIMD::MultiplyAndAccumulate for the AVX512 implementation.
+            template<typename T, typename OT>
+            static inline Vec256<OT> MultiplyAndAccumulate(const Vec256<OT>& sum, const Vec256<T>& input,
+                                                           const Vec256<T>& weight)
+            {
+                if constexpr (std::is_floating_point_v<T>) return Avx2<T>::MultiplyAdd(input, weight, sum);
+                else return Avx2<OT>::Add(sum, Avx2<T>::MultiplyAndAddAdjacent(input, weight));
+            }
+#endif
+
         public:
-            /// \brief Add the delta to elements in the input arrays.
-            /// \tparam T The type of the input and delta.
-            /// \tparam InputSize The size of the input arrays.
+            /// \brief Add the delta to the values of both perspectives.
+            /// \tparam Layout The layout of the perspectives in the value arrays.
+            /// \tparam T The type of the values and delta.
+            /// \tparam ValueSize The size of the value arrays, holding both perspectives.
             /// \tparam DeltaSize The size of the delta array.
-            /// \param inputA The first input array.
-            /// \param inputB The second input array.
+            /// \param input The input values.
+            /// \param output The output values, which may be the input values.
             /// \param delta The delta array.
-            /// \param oA The delta offset for the first input array.
-            /// \param oB The delta offset for the second input array.
-            /// \details This function adds the offset delta to elements in the input arrays.
-            ///          The delta is added to the input arrays in-place.
-            template<typename T, size_t InputSize, size_t DeltaSize>
-            static inline void AddToAll(std::array<T, InputSize>& inputA, std::array<T, InputSize>& inputB,
+            /// \param oA The delta offset for the first (white) perspective.
+            /// \param oB The delta offset for the second (black) perspective.
+            /// \details This function adds the offset delta to the values of both perspectives, storing the results
+            ///          in the output values. This fuses copying a parent accumulator into a child accumulator with the
+            ///          update of the child. Split perspectives are walked one after the other, while interleaved
+            ///          perspectives are walked together in a single pass.
+            template<AccumulatorLayout Layout, typename T, size_t ValueSize, size_t DeltaSize>
+            static inline void AddToAll(const std::array<T, ValueSize>& input, std::array<T, ValueSize>& output,
                                         const std::array<T, DeltaSize>& delta,
                                         const uint32_t oA, const uint32_t oB)
             {
+                using Storage = PerspectiveStorage<Layout, T, ValueSize / 2>;
+
+                // Define the delta offset of every perspective:
+                const std::array<uint32_t, 2> offset = { oA, oB };
 #ifdef __AVX512BW__
                 // Define the registers used in the loops:
-                Vec512I zmm0;
-                Vec512I zmm1;
+                Vec512<T> zmm0;
+                Vec512<T> zmm1;
 
                 // Define the step size for the loops:
                 constexpr size_t Step = sizeof(Vec512I) / sizeof(T);
 
-                //region INPUT A
-                for (size_t i = 0; i < InputSize; i += Step) {
-                    // Load the input and delta values into the registers:
-                    zmm0 = Avx512<T>::From(inputA,      i);
-                    zmm1 = Avx512<T>::From(delta , oA + i);
-
-                    // Add the delta register to the input register:
-                    zmm0 = Avx512<T>::Add(zmm0, zmm1);
+                for (uint8_t pass = 0; pass < Storage::Passes; pass++)
+                    for (size_t i = 0; i < ValueSize / 2; i += Storage::Run)
+#pragma GCC unroll 2
+                        for (uint8_t p = pass; p < pass + Storage::PerPass; p++)
+#pragma GCC unroll 16
+                            for (size_t j = 0; j < Storage::Run; j += Step) {
+                                const size_t index = Storage::Index(p, i) + j;
 
-                    // Store the result back from the input register to the input array:
-                    Avx512<T>::Store(zmm0, inputA, i);
-                }
-                //endregion
+                                // Load the input and delta values into the registers:
+                                zmm0 = Avx512<T>::From(input,             index);
+                                zmm1 = Avx512<T>::From(delta, offset[p] + i + j);
 
-                //region INPUT B
-                for (size_t i = 0; i < InputSize; i += Step) {
-                    // Load the input and delta values into the registers:
-                    zmm0 = Avx512<T>::From(inputB,      i);
-                    zmm1 = Avx512<T>::From(delta , oB + i);
+                                // Add the delta register to the input register:
+                                zmm0 = Avx512<T>::Add(zmm0, zmm1);
 
-                    // Add the delta register to the input register:
-                    zmm0 = Avx512<T>::Add(zmm0, zmm1);
-
-                    // Store the result back from the input register to the input array:
-                    Avx512<T>::Store(zmm0, inputB, i);
-                }
-                //endregion
+                                // Store the result from the input register to the output array:
+                                Avx512<T>::Store(zmm0, output, index);
+                            }
 #elifdef __AVX2__
                 // Define the registers used in the loops:
-                Vec256I ymm0;
-                Vec256I ymm1;
+                Vec256<T> ymm0;
+                Vec256<T> ymm1;
 
                 // Define the step size for the loops:
                 constexpr size_t Step = sizeof(Vec256I) / sizeof(T);
 
-                //region INPUT A
-                for (size_t i = 0; i < InputSize; i += Step) {
-                    // Load the input and delta values into the registers:
-                    ymm0 = Avx<T> ::From(inputA,      i);
-                    ymm1 = Avx<T> ::From(delta , oA + i);
-
-                    // Add the delta register to the input register:
-                    ymm0 = Avx2<T>::Add(ymm0, ymm1);
-
-                    // Store the result back from the input register to the input array:
-                    Avx<T>::Store(ymm0, inputA, i);
-                }
-                //endregion
+                for (uint8_t pass = 0; pass < Storage::Passes; pass++)
+                    for (size_t i = 0; i < ValueSize / 2; i += Storage::Run)
+#pragma GCC unroll 2
+                        for (uint8_t p = pass; p < pass + Storage::PerPass; p++)
+#pragma GCC unroll 16
+                            for (size_t j = 0; j < Storage::Run; j += Step) {
+                                const size_t index = Storage::Index(p, i) + j;
 
-                //region INPUT B
-                for (size_t i = 0; i < InputSize; i += Step) {
-                    // Load the input and delta values into the registers:
-                    ymm0 = Avx<T> ::From(inputB,      i);
-                    ymm1 = Avx<T> ::From(delta , oB + i);
+                                // Load the input and delta values into the registers:
+                                ymm0 = Avx<T> ::From(input,             index);
+                                ymm1 = Avx<T> ::From(delta, offset[p] + i + j);
 
-                    // Add the delta register to the input register:
-                    ymm0 = Avx2<T>::Add(ymm0, ymm1);
+                                // Add the delta register to the input register:
+                                ymm0 = Avx2<T>::Add(ymm0, ymm1);
 
-                    // Store the result back from the input register to the input array:
-                    Avx<T>::Store(ymm0, inputB, i);
-                }
-                //endregion
+                                // Store the result from the input register to the output array:
+                                Avx<T>::Store(ymm0, output, index);
+                            }
 #else
-                // Add the delta to the input arrays:
-                for (size_t i = 0; i < InputSize; i++) inputA[i] += delta[oA + i];
-                for (size_t i = 0; i < InputSize; i++) inputB[i] += delta[oB + i];
+                // Add the delta to the values:
+                for (uint8_t pass = 0; pass < Storage::Passes; pass++)
+                    for (size_t i = 0; i < ValueSize / 2; i += Storage::Run)
+                        for (uint8_t p = pass; p < pass + Storage::PerPass; p++) {
+                            const size_t index = Storage::Index(p, i);
+                            for (size_t j = 0; j < Storage::Run; j++)
+                                output[index + j] = input[index + j] + delta[offset[p] + i + j];
+                        }
 #endif
             }
 
-            /// \brief Subtract the delta from elements in the input arrays.
-            /// \tparam T The type of the input and delta.
-            /// \tparam InputSize The size of the input arrays.
+            /// \brief Add the delta to the values of both perspectives in-place.
+            /// \see MantaRay::SIMD::AddToAll for the parameters.
+            template<AccumulatorLayout Layout, typename T, size_t ValueSize, size_t DeltaSize>
+            static inline void AddToAll(std::array<T, ValueSize>& values, const std::array<T, DeltaSize>& delta,
+                                        const uint32_t oA, const uint32_t oB)
+            {
+                AddToAll<Layout>(values, values, delta, oA, oB);
+            }
+
+            /// \brief Subtract the delta from the values of both perspectives.
+            /// \tparam Layout The layout of the perspectives in the value arrays.
+            /// \tparam T The type of the values and delta.
+            /// \tparam ValueSize The size of the value arrays, holding both perspectives.
             /// \tparam DeltaSize The size of the delta array.
-            /// \param inputA The first input array.
-            /// \param inputB The second input array.
+            /// \param input The input values.
+            /// \param output The output values, which may be the input values.
             /// \param delta The delta array.
-            /// \param oA The delta offset for the first input array.
-            /// \param oB The delta offset for the second input array.
-            /// \details This function subtracts the offset delta from elements in the input arrays.
-            ///          The delta is subtracted from the input arrays in-place.
-            template<typename T, size_t InputSize, size_t DeltaSize>
-            static inline void SubtractFromAll(std::array<T, InputSize>& inputA, std::array<T, InputSize>& inputB,
+            /// \param oA The delta offset for the first (white) perspective.
+            /// \param oB The delta offset for the second (black) perspective.
+            /// \details This function subtracts the offset delta from the values of both perspectives, storing the
+            ///          results in the output values. This fuses copying a parent accumulator into a child accumulator
+            ///          with the update of the child.
+            /// \see MantaRay::SIMD::AddToAll for the order the perspectives are walked in.
+            template<AccumulatorLayout Layout, typename T, size_t ValueSize, size_t DeltaSize>
+            static inline void SubtractFromAll(const std::array<T, ValueSize>& input, std::array<T, ValueSize>& output,
                                                const std::array<T, DeltaSize>& delta,
                                                const uint32_t oA, const uint32_t oB)
             {
+                using Storage = PerspectiveStorage<Layout, T, ValueSize / 2>;
+
+                // Define the delta offset of every perspective:
+                const std::array<uint32_t, 2> offset = { oA, oB };
 #ifdef __AVX512BW__
                 // Define the registers used in the loops:
-                Vec512I zmm0;
-                Vec512I zmm1;
+                Vec512<T> zmm0;
+                Vec512<T> zmm1;
 
                 // Define the step size for the loops:
                 constexpr size_t Step = sizeof(Vec512I) / sizeof(T);
 
-                //region INPUT A
-                for (size_t i = 0; i < InputSize; i += Step) {
-                    // Load the input and delta values into the registers:
-                    zmm0 = Avx512<T>::From(inputA,      i);
-                    zmm1 = Avx512<T>::From(delta , oA + i);
-
-                    // Subtract the delta register from the input register:
-                    zmm0 = Avx512<T>::Subtract(zmm0, zmm1);
-
-                    // Store the result back from the input register to the input array:
-                    Avx512<T>::Store(zmm0, inputA, i);
-                }
-                //endregion
+                for (uint8_t pass = 0; pass < Storage::Passes; pass++)
+                    for (size_t i = 0; i < ValueSize / 2; i += Storage::Run)
+#pragma GCC unroll 2
+                        for (uint8_t p = pass; p < pass + Storage::PerPass; p++)
+#pragma GCC unroll 16
+                            for (size_t j = 0; j < Storage::Run; j += Step) {
+                                const size_t index = Storage::Index(p, i) + j;
 
-                //region INPUT B
-                for (size_t i = 0; i < InputSize; i += Step) {
-                    // Load the input and delta values into the registers:
-                    zmm0 = Avx512<T>::From(inputB,      i);
-                    zmm1 = Avx512<T>::From(delta , oB + i);
+                                // Load the input and delta values into the registers:
+                                zmm0 = Avx512<T>::From(input,             index);
+                                zmm1 = Avx512<T>::From(delta, offset[p] + i + j);
 
-                    // Subtract the delta register from the input register:
-                    zmm0 = Avx512<T>::Subtract(zmm0, zmm1);
+                                // Subtract the delta register from the input register:
+                                zmm0 = Avx512<T>::Subtract(zmm0, zmm1);
 
-                    // Store the result back from the input register to the input array:
-                    Avx512<T>::Store(zmm0, inputB, i);
-                }
-                //endregion
+                                // Store the result from the input register to the output array:
+                                Avx512<T>::Store(zmm0, output, index);
+                            }
 #elifdef __AVX2__
                 // Define the registers used in the loops:
-                Vec256I ymm0;
-                Vec256I ymm1;
+                Vec256<T> ymm0;
+                Vec256<T> ymm1;
 
                 // Define the step size for the loops:
                 constexpr size_t Step = sizeof(Vec256I) / sizeof(T);
 
-                //region INPUT A
-                for (size_t i = 0; i < InputSize; i += Step) {
-                    // Load the input and delta values into the registers:
-                    ymm0 = Avx<T> ::From(inputA,      i);
-                    ymm1 = Avx<T> ::From(delta , oA + i);
-
-                    // Subtract the delta register from the input register:
-                    ymm0 = Avx2<T>::Subtract(ymm0, ymm1);
+                for (uint8_t pass = 0; pass < Storage::Passes; pass++)
+                    for (size_t i = 0; i < ValueSize / 2; i += Storage::Run)
+#pragma GCC unroll 2
+                        for (uint8_t p = pass; p < pass + Storage::PerPass; p++)
+#pragma GCC unroll 16
+                            for (size_t j = 0; j < Storage::Run; j += Step) {
+                                const size_t index = Storage::Index(p, i) + j;
 
-                    // Store the result back from the input register to the input array:
-                    Avx<T>::Store(ymm0, inputA, i);
-                }
-                //endregion
-
-                //region INPUT B
-                for (size_t i = 0; i < InputSize; i += Step) {
-                    // Load the input and delta values into the registers:
-                    ymm0 = Avx<T> ::From(inputB,      i);
-                    ymm1 = Avx<T> ::From(delta , oB + i);
+                                // Load the input and delta values into the registers:
+                                ymm0 = Avx<T> ::From(input,             index);
+                                ymm1 = Avx<T> ::From(delta, offset[p] + i + j);
 
-                    // Subtract the delta register from the input register:
-                    ymm0 = Avx2<T>::Subtract(ymm0, ymm1);
+                                // Subtract the delta register from the input register:
+                                ymm0 = Avx2<T>::Subtract(ymm0, ymm1);
 
-                    // Store the result back from the input register to the input array:
-                    Avx<T>::Store(ymm0, inputB, i);
-                }
-                //endregion
+                                // Store the result from the input register to the output array:
+                                Avx<T>::Store(ymm0, output, index);
+                            }
 #else
-                // Subtract the delta from the input arrays:
-                for (size_t i = 0; i < InputSize; i++) inputA[i] -= delta[oA + i];
-                for (size_t i = 0; i < InputSize; i++) inputB[i] -= delta[oB + i];
+                // Subtract the delta from the values:
+                for (uint8_t pass = 0; pass < Storage::Passes; pass++)
+                    for (size_t i = 0; i < ValueSize / 2; i += Storage::Run)
+                        for (uint8_t p = pass; p < pass + Storage::PerPass; p++) {
+                            const size_t index = Storage::Index(p, i);
+                            for (size_t j = 0; j < Storage::Run; j++)
+                                output[index + j] = input[index + j] - delta[offset[p] + i + j];
+                        }
 #endif
             }
 
+            /// \brief Subtract the delta from the values of both perspectives in-place.
+            /// \see MantaRay::SIMD::SubtractFromAll for the parameters.
+            template<AccumulatorLayout Layout, typename T, size_t ValueSize, size_t DeltaSize>
+            static inline void SubtractFromAll(std::array<T, ValueSize>& values, const std::array<T, DeltaSize>& delta,
+                                               const uint32_t oA, const uint32_t oB)
+            {
+                SubtractFromAll<Layout>(values, values, delta, oA, oB);
+            }
+
             /// \brief Combination of SubtractFromAll and AddToAll.
-            /// \tparam T The type of the input and delta.
-            /// \tparam InputSize The size of the input arrays.
+            /// \tparam Layout The layout of the perspectives in the value arrays.
+            /// \tparam T The type of the values and delta.
+            /// \tparam ValueSize The size of the value arrays, holding both perspectives.
             /// \tparam DeltaSize The size of the delta array.
-            /// \param inputA The first input array.
-            /// \param inputB The second input array.
+            /// \param input The input values.
+            /// \param output The output values, which may be the input values.
             /// \param delta The delta array.
-            /// \param oAS The delta offset for the first input array with respect to subtraction.
-            /// \param oAA The delta offset for the first input array with respect to addition.
-            /// \param oBS The delta offset for the second input array with respect to subtraction.
-            /// \param oBA The delta offset for the second input array with respect to addition.
-            /// \details This function subtracts the offset delta from elements in the input arrays.
-            ///          The delta is subtracted from the input arrays in-place.
-            ///          Then another offset delta is added to the input arrays.
-            ///          The delta is added to the input arrays in-place.
-            template<typename T, size_t InputSize, size_t DeltaSize>
-            static inline void SubtractAndAddToAll(std::array<T, InputSize>& inputA, std::array<T, InputSize>& inputB,
+            /// \param oAS The delta offset for the first (white) perspective with respect to subtraction.
+            /// \param oAA The delta offset for the first (white) perspective with respect to addition.
+            /// \param oBS The delta offset for the second (black) perspective with respect to subtraction.
+            /// \param oBA The delta offset for the second (black) perspective with respect to addition.
+            /// \details This function subtracts the offset delta from the values of both perspectives.
+            ///          Then another offset delta is added to the values.
+            ///          The results are stored in the output values.
+            /// \see MantaRay::SIMD::AddToAll for the order the perspectives are walked in.
+            template<AccumulatorLayout Layout, typename T, size_t ValueSize, size_t DeltaSize>
+            static inline void SubtractAndAddToAll(const std::array<T, ValueSize>& input,
+                                                   std::array<T, ValueSize>& output,
                                                    const std::array<T, DeltaSize>& delta,
                                                    const uint32_t oAS, const uint32_t oAA,
                                                    const uint32_t oBS, const uint32_t oBA)
             {
+                using Storage = PerspectiveStorage<Layout, T, ValueSize / 2>;
+
+                // Define the delta offsets of every perspective:
+                const std::array<uint32_t, 2> subtract = { oAS, oBS };
+                const std::array<uint32_t, 2> add      = { oAA, oBA };
 #ifdef __AVX512BW__
                 // Define the registers used in the loops:
-                Vec512I zmm0;
-                Vec512I zmm1;
-                Vec512I zmm2;
+                Vec512<T> zmm0;
+                Vec512<T> zmm1;
+                Vec512<T> zmm2;
 
                 // Define the step size for the loops:
                 constexpr size_t Step = sizeof(Vec512I) / sizeof(T);
 
-                //region INPUT A
-                for (size_t i = 0; i < InputSize; i += Step) {
-                    // Load the input and delta values into the registers:
-                    zmm0 = Avx512<T>::From(inputA,       i);
-                    zmm1 = Avx512<T>::From(delta , oAS + i);
-                    zmm2 = Avx512<T>::From(delta , oAA + i);
-
-                    // Subtract and add the delta register to the input register:
-                    zmm0 = Avx512<T>::Subtract(zmm0, zmm1);
-                    zmm0 = Avx512<T>::Add(zmm0, zmm2);
-
-                    // Store the result back from the input register to the input array:
-                    Avx512<T>::Store(zmm0, inputA, i);
-                }
-                //endregion
-
-                //region INPUT B
-                for (size_t i = 0; i < InputSize; i += Step) {
-                    // Load the input and delta values into the registers:
-                    zmm0 = Avx512<T>::From(inputB,       i);
-                    zmm1 = Avx512<T>::From(delta , oBS + i);
-                    zmm2 = Avx512<T>::From(delta , oBA + i);
-
-                    // Subtract and add the delta register to the input register:
-                    zmm0 = Avx512<T>::Subtract(zmm0, zmm1);
-                    zmm0 = Avx512<T>::Add(zmm0, zmm2);
-
-                    // Store the result back from the input register to the input array:
-                    Avx512<T>::Store(zmm0, inputB, i);
-                }
-                //endregion
+                for (uint8_t pass = 0; pass < Storage::Passes; pass++)
+                    for (size_t i = 0; i < ValueSize / 2; i += Storage::Run)
+#pragma GCC unroll 2
+                        for (uint8_t p = pass; p < pass + Storage::PerPass; p++)
+#pragma GCC unroll 16
+                            for (size_t j = 0; j < Storage::Run; j += Step) {
+                                const size_t index = Storage::Index(p, i) + j;
+
+                                // Load the input and delta values into the registers:
+                                zmm0 = Avx512<T>::From(input,               index);
+                                zmm1 = Avx512<T>::From(delta, subtract[p] + i + j);
+                                zmm2 = Avx512<T>::From(delta, add     [p] + i + j);
+
+                                // Subtract and add the delta register to the input register:
+                                zmm0 = Avx512<T>::Subtract(zmm0, zmm1);
+                                zmm0 = Avx512<T>::Add(zmm0, zmm2);
+
+                                // Store the result from the input register to the output array:
+                                Avx512<T>::Store(zmm0, output, index);
+                            }
 #elifdef __AVX2__
                 // Define the registers used in the loops:
-                Vec256I ymm0;
-                Vec256I ymm1;
-                Vec256I ymm2;
+                Vec256<T> ymm0;
+                Vec256<T> ymm1;
+                Vec256<T> ymm2;
 
                 // Define the step size for the loops:
                 constexpr size_t Step = sizeof(Vec256I) / sizeof(T);
 
-                //region INPUT A
-                for (size_t i = 0; i < InputSize; i += Step) {
-                    // Load the input and delta values into the registers:
-                    ymm0 = Avx<T> ::From(inputA,       i);
-                    ymm1 = Avx<T> ::From(delta , oAS + i);
-                    ymm2 = Avx<T> ::From(delta , oAA + i);
-
-                    // Subtract and add the delta registers to the input register:
-                    ymm0 = Avx2<T>::Subtract(ymm0, ymm1);
-                    ymm0 = Avx2<T>::Add(ymm0, ymm2);
+                for (uint8_t pass = 0; pass < Storage::Passes; pass++)
+                    for (size_t i = 0; i < ValueSize / 2; i += Storage::Run)
+#pragma GCC unroll 2
+                        for (uint8_t p = pass; p < pass + Storage::PerPass; p++)
+#pragma GCC unroll 16
+                            for (size_t j = 0; j < Storage::Run; j += Step) {
+                                const size_t index = Storage::Index(p, i) + j;
+
+                                // Load the input and delta values into the registers:
+                                ymm0 = Avx<T> ::From(input,               index);
+                                ymm1 = Avx<T> ::From(delta, subtract[p] + i + j);
+                                ymm2 = Avx<T> ::From(delta, add     [p] + i + j);
+
+                                // Subtract and add the delta register to the input register:
+                                ymm0 = Avx2<T>::Subtract(ymm0, ymm1);
+                                ymm0 = Avx2<T>::Add(ymm0, ymm2);
+
+                                // Store the result from the input register to the output array:
+                                Avx<T>::Store(ymm0, output, index);
+                            }
+#else
+                // Subtract and add the delta to the values:
+                for (uint8_t pass = 0; pass < Storage::Passes; pass++)
+                    for (size_t i = 0; i < ValueSize / 2; i += Storage::Run)
+                        for (uint8_t p = pass; p < pass + Storage::PerPass; p++) {
+                            const size_t index = Storage::Index(p, i);
+                            for (size_t j = 0; j < Storage::Run; j++)
+                                output[index + j] = input[index + j] - delta[subtract[p] + i + j]
+                                                                     + delta[add     [p] + i + j];
+                        }
+#endif
+            }
 
-                    // Store the result back from the input register to the input array:
-                    Avx<T>::Store(ymm0, inputA, i);
-                }
-                //endregion
+            /// \brief Combination of SubtractFromAll and AddToAll, in-place.
+            /// \see MantaRay::SIMD::SubtractAndAddToAll for the parameters.
+            template<AccumulatorLayout Layout, typename T, size_t ValueSize, size_t DeltaSize>
+            static inline void SubtractAndAddToAll(std::array<T, ValueSize>& values,
+                                                   const std::array<T, DeltaSize>& delta,
+                                                   const uint32_t oAS, const uint32_t oAA,
+                                                   const uint32_t oBS, const uint32_t oBA)
+            {
+                SubtractAndAddToAll<Layout>(values, values, delta, oAS, oAA, oBS, oBA);
+            }
 
-                //region INPUT B
-                for (size_t i = 0; i < InputSize; i += Step) {
-                    // Load the input and delta values into the registers:
-                    ymm0 = Avx<T> ::From(inputB,       i);
-                    ymm1 = Avx<T> ::From(delta , oBS + i);
-                    ymm2 = Avx<T> ::From(delta , oBA + i);
+            /// \brief Sum rows of the delta onto the bias, for both perspectives.
+            /// \tparam Layout The layout of the perspectives in the output array.
+            /// \tparam T The type of the bias, delta and output.
+            /// \tparam ValueSize The size of the output array, holding both perspectives. The bias and every row
+            ///                   are half as long.
+            /// \tparam DeltaSize The size of the delta array.
+            /// \param bias The bias array.
+            /// \param delta The delta array, made of rows of half the value size.
+            /// \param rowsA The indices of the rows to sum for the first (white) perspective.
+            /// \param rowsB The indices of the rows to sum for the second (black) perspective.
+            /// \param count The number of rows to sum for every perspective.
+            /// \param output The output array.
+            /// \details This function keeps a tile of a perspective in registers while the tile of every row is
+            ///          added to it, and stores the tile once all rows were added, so the output is written exactly
+            ///          once instead of once per row, and every row is read in contiguous runs.
+            template<AccumulatorLayout Layout, typename T, size_t ValueSize, size_t DeltaSize>
+            static inline void AccumulateRows(const std::array<T, ValueSize / 2>& bias,
+                                              const std::array<T, DeltaSize>& delta,
+                                              const uint16_t* rowsA, const uint16_t* rowsB, const size_t count,
+                                              std::array<T, ValueSize>& output)
+            {
+                using Storage = PerspectiveStorage<Layout, T, ValueSize / 2>;
 
-                    // Subtract and add the delta registers to the input register:
-                    ymm0 = Avx2<T>::Subtract(ymm0, ymm1);
-                    ymm0 = Avx2<T>::Add(ymm0, ymm2);
+                // Define the size of a row, and the rows of every perspective:
+                constexpr size_t RowSize = ValueSize / 2;
+                const std::array<const uint16_t*, 2> rows = { rowsA, rowsB };
+#ifdef __AVX512BW__
+                // Define the step size and the number of registers of a tile:
+                constexpr size_t Step = sizeof(Vec512I) / sizeof(T);
+                constexpr size_t Tile = TileRegisters(RowSize / Step);
+
+                // The tiles must cover the row exactly, or the last tile would read and write past its end:
+                static_assert(RowSize % (Step * Tile) == 0, "The tile must divide the row.");
+
+                // Define the registers of the tile:
+                Vec512<T> zmm0[Tile];
+
+                for (uint8_t pass = 0; pass < Storage::Passes; pass++)
+                    for (size_t i = 0; i < RowSize; i += Step * Tile)
+                        for (uint8_t p = pass; p < pass + Storage::PerPass; p++) {
+                            // Load the bias values into the tile:
+#pragma GCC unroll 32
+                            for (size_t t = 0; t < Tile; t++) zmm0[t] = Avx512<T>::From(bias, i + t * Step);
+
+                            // Add the delta values of every row to the tile:
+                            for (size_t r = 0; r < count; r++) {
+                                const size_t offset = rows[p][r] * RowSize + i;
+
+#pragma GCC unroll 32
+                                for (size_t t = 0; t < Tile; t++)
+                                    zmm0[t] = Avx512<T>::Add(zmm0[t], Avx512<T>::From(delta, offset + t * Step));
+                            }
+
+                            // Store the tile to the output array:
+#pragma GCC unroll 32
+                            for (size_t t = 0; t < Tile; t++)
+                                Avx512<T>::Store(zmm0[t], output, Storage::Index(p, i + t * Step));
+                        }
+#elifdef __AVX2__
+                // Define the step size and the number of registers of a tile:
+                constexpr size_t Step = sizeof(Vec256I) / sizeof(T);
+                constexpr size_t Tile = TileRegisters(RowSize / Step);
+
+                // The tiles must cover the row exactly, or the last tile would read and write past its end:
+                static_assert(RowSize % (Step * Tile) == 0, "The tile must divide the row.");
+
+                // Define the registers of the tile:
+                Vec256<T> ymm0[Tile];
+
+                for (uint8_t pass = 0; pass < Storage::Passes; pass++)
+                    for (size_t i = 0; i < RowSize; i += Step * Tile)
+                        for (uint8_t p = pass; p < pass + Storage::PerPass; p++) {
+                            // Load the bias values into the tile:
+#pragma GCC unroll 16
+                            for (size_t t = 0; t < Tile; t++) ymm0[t] = Avx<T>::From(bias, i + t * Step);
+
+                            // Add the delta values of every row to the tile:
+                            for (size_t r = 0; r < count; r++) {
+                                const size_t offset = rows[p][r] * RowSize + i;
+
+#pragma GCC unroll 16
+                                for (size_t t = 0; t < Tile; t++)
+                                    ymm0[t] = Avx2<T>::Add(ymm0[t], Avx<T>::From(delta, offset + t * Step));
+                            }
+
+                            // Store the tile to the output array:
+#pragma GCC unroll 16
+                            for (size_t t = 0; t < Tile; t++)
+                                Avx<T>::Store(ymm0[t], output, Storage::Index(p, i + t * Step));
+                        }
+#else
+                for (uint8_t p = 0; p < 2; p++) {
+                    // Add the rows to the bias in a local array, which can't alias the delta:
+                    std::array<T, RowSize> sum = bias;
+                    for (size_t r = 0; r < count; r++) {
+                        const T* row = delta.data() + rows[p][r] * RowSize;
+                        for (size_t i = 0; i < RowSize; i++) sum[i] += row[i];
+                    }
 
-                    // Store the result back from the input register to the input array:
-                    Avx<T>::Store(ymm0, inputB, i);
+                    for (size_t i = 0; i < RowSize; i += Storage::Run)
+                        std::copy_n(sum.begin() + i, Storage::Run, output.begin() + Storage::Index(p, i));
                 }
-                //endregion
+#endif
+            }
+
+            /// \brief Subtract and add rows of the delta from and to the values of both perspectives, in a single pass.
+            /// \tparam Layout The layout of the perspectives in the value arrays.
+            /// \tparam Removed The number of rows to subtract for every perspective.
+            /// \tparam Added The number of rows to add for every perspective.
+            /// \tparam T The type of the values and delta.
+            /// \tparam ValueSize The size of the value arrays, holding both perspectives. Every row is half as long.
+            /// \tparam DeltaSize The size of the delta array.
+            /// \tparam SparseSize The size of the sparse delta array.
+            /// \param input The input values.
+            /// \param output The output values, which may be the input values.
+            /// \param delta The delta array, made of rows of half the value size.
+            /// \param removed The indices of the rows to subtract, for the first (white) and second (black)
+            ///                perspective.
+            /// \param added The indices of the rows to add, for the first (white) and second (black) perspective.
+            /// \param sparse The sparse delta array, made of rows of half the value size.
+            /// \param sparseRemoved The indices of the sparse rows to subtract, for both perspectives.
+            /// \param sparseAdded The indices of the sparse rows to add, for both perspectives.
+            /// \details This function loads a tile of a perspective into registers, applies every row to it, and
+            ///          stores the tile once, so an update touching several features (such as a capture or castling)
+            ///          reads and writes the values once instead of once per feature. The tile is sized at compile
+            ///          time from the hidden size and the registers of the instruction set, so small enough hidden
+            ///          layers are kept in registers as a whole perspective.
+            ///
+            ///          The rows of the sparse delta, whose number is only known at runtime (such as the threat
+            ///          features changed by a move), are applied to the tile in the same pass.
+            template<AccumulatorLayout Layout, size_t Removed, size_t Added, typename T, size_t ValueSize,
+                     size_t DeltaSize, size_t SparseSize>
+            static inline void SubtractAndAddRows(const std::array<T, ValueSize>& input,
+                                                  std::array<T, ValueSize>& output,
+                                                  const std::array<T, DeltaSize>& delta,
+                                                  const std::array<std::array<uint32_t, Removed>, 2>& removed,
+                                                  const std::array<std::array<uint32_t, Added  >, 2>& added,
+                                                  const std::array<T, SparseSize>& sparse,
+                                                  const std::array<std::span<const uint32_t>, 2>& sparseRemoved,
+                                                  const std::array<std::span<const uint32_t>, 2>& sparseAdded)
+            {
+                using Storage = PerspectiveStorage<Layout, T, ValueSize / 2>;
+
+                // Define the size of a row:
+                constexpr size_t RowSize = ValueSize / 2;
+#ifdef __AVX512BW__
+                // Define the step size and the number of registers of a tile:
+                constexpr size_t Step = sizeof(Vec512I) / sizeof(T);
+                constexpr size_t Tile = TileRegisters(RowSize / Step);
+
+                // The tiles must cover the row exactly, or the last tile would read and write past its end:
+                static_assert(RowSize % (Step * Tile) == 0, "The tile must divide the row.");
+
+                // Define the registers of the tile:
+                Vec512<T> zmm0[Tile];
+
+                for (uint8_t pass = 0; pass < Storage::Passes; pass++)
+                    for (size_t i = 0; i < RowSize; i += Step * Tile)
+                        for (uint8_t p = pass; p < pass + Storage::PerPass; p++) {
+                            // Load the input values into the tile:
+#pragma GCC unroll 32
+                            for (size_t t = 0; t < Tile; t++)
+                                zmm0[t] = Avx512<T>::From(input, Storage::Index(p, i + t * Step));
+
+                            // Subtract the delta values of every removed row from the tile:
+#pragma GCC unroll 4
+                            for (size_t r = 0; r < Removed; r++) {
+                                const size_t offset = removed[p][r] * RowSize + i;
+
+#pragma GCC unroll 32
+                                for (size_t t = 0; t < Tile; t++)
+                                    zmm0[t] = Avx512<T>::Subtract(zmm0[t], Avx512<T>::From(delta, offset + t * Step));
+                            }
+
+                            // Add the delta values of every added row to the tile:
+#pragma GCC unroll 4
+                            for (size_t r = 0; r < Added; r++) {
+                                const size_t offset = added[p][r] * RowSize + i;
+
+#pragma GCC unroll 32
+                                for (size_t t = 0; t < Tile; t++)
+                                    zmm0[t] = Avx512<T>::Add(zmm0[t], Avx512<T>::From(delta, offset + t * Step));
+                            }
+
+                            // Subtract and add the sparse delta values of every sparse row, if there are any:
+                            if constexpr (SparseSize > 0) {
+                                for (const uint32_t row : sparseRemoved[p]) {
+                                    const size_t offset = row * RowSize + i;
+
+#pragma GCC unroll 32
+                                    for (size_t t = 0; t < Tile; t++)
+                                        zmm0[t] = Avx512<T>::Subtract(zmm0[t],
+                                                                      Avx512<T>::From(sparse, offset + t * Step));
+                                }
+
+                                for (const uint32_t row : sparseAdded[p]) {
+                                    const size_t offset = row * RowSize + i;
+
+#pragma GCC unroll 32
+                                    for (size_t t = 0; t < Tile; t++)
+                                        zmm0[t] = Avx512<T>::Add(zmm0[t], Avx512<T>::From(sparse, offset + t * Step));
+                                }
+                            }
+
+                            // Store the tile to the output array:
+#pragma GCC unroll 32
+                            for (size_t t = 0; t < Tile; t++)
+                                Avx512<T>::Store(zmm0[t], output, Storage::Index(p, i + t * Step));
+                        }
+#elifdef __AVX2__
+                // Define the step size and the number of registers of a tile:
+                constexpr size_t Step = sizeof(Vec256I) / sizeof(T);
+                constexpr size_t Tile = TileRegisters(RowSize / Step);
+
+                // The tiles must cover the row exactly, or the last tile would read and write past its end:
+                static_assert(RowSize % (Step * Tile) == 0, "The tile must divide the row.");
+
+                // Define the registers of the tile:
+                Vec256<T> ymm0[Tile];
+
+                for (uint8_t pass = 0; pass < Storage::Passes; pass++)
+                    for (size_t i = 0; i < RowSize; i += Step * Tile)
+                        for (uint8_t p = pass; p < pass + Storage::PerPass; p++) {
+                            // Load the input values into the tile:
+#pragma GCC unroll 16
+                            for (size_t t = 0; t < Tile; t++)
+                                ymm0[t] = Avx<T>::From(input, Storage::Index(p, i + t * Step));
+
+                            // Subtract the delta values of every removed row from the tile:
+#pragma GCC unroll 4
+                            for (size_t r = 0; r < Removed; r++) {
+                                const size_t offset = removed[p][r] * RowSize + i;
+
+#pragma GCC unroll 16
+                                for (size_t t = 0; t < Tile; t++)
+                                    ymm0[t] = Avx2<T>::Subtract(ymm0[t], Avx<T>::From(delta, offset + t * Step));
+                            }
+
+                            // Add the delta values of every added row to the tile:
+#pragma GCC unroll 4
+                            for (size_t r = 0; r < Added; r++) {
+                                const size_t offset = added[p][r] * RowSize + i;
+
+#pragma GCC unroll 16
+                                for (size_t t = 0; t < Tile; t++)
+                                    ymm0[t] = Avx2<T>::Add(ymm0[t], Avx<T>::From(delta, offset + t * Step));
+                            }
+
+                            // Subtract and add the sparse delta values of every sparse row, if there are any:
+                            if constexpr (SparseSize > 0) {
+                                for (const uint32_t row : sparseRemoved[p]) {
+                                    const size_t offset = row * RowSize + i;
+
+#pragma GCC unroll 16
+                                    for (size_t t = 0; t < Tile; t++)
+                                        ymm0[t] = Avx2<T>::Subtract(ymm0[t], Avx<T>::From(sparse, offset + t * Step));
+                                }
+
+                                for (const uint32_t row : sparseAdded[p]) {
+                                    const size_t offset = row * RowSize + i;
+
+#pragma GCC unroll 16
+                                    for (size_t t = 0; t < Tile; t++)
+                                        ymm0[t] = Avx2<T>::Add(ymm0[t], Avx<T>::From(sparse, offset + t * Step));
+                                }
+                            }
+
+                            // Store the tile to the output array:
+#pragma GCC unroll 16
+                            for (size_t t = 0; t < Tile; t++)
+                                Avx<T>::Store(ymm0[t], output, Storage::Index(p, i + t * Step));
+                        }
 #else
-                // Subtract and add the delta to the input arrays:
-                for (size_t i = 0; i < InputSize; i++) {
-                    inputA[i] = inputA[i] - delta[oAS + i] + delta[oAA + i];
-                    inputB[i] = inputB[i] - delta[oBS + i] + delta[oBA + i];
-                }
+                for (uint8_t p = 0; p < 2; p++)
+                    for (size_t i = 0; i < RowSize; i += Storage::Run) {
+                        const size_t index = Storage::Index(p, i);
+
+                        // Apply every row to a value before it is stored, as the output may be the input:
+                        for (size_t j = 0; j < Storage::Run; j++) {
+                            T value = input[index + j];
+                            for (size_t r = 0; r < Removed; r++) value -= delta[removed[p][r] * RowSize + i + j];
+                            for (size_t r = 0; r < Added  ; r++) value += delta[added  [p][r] * RowSize + i + j];
+
+                            if constexpr (SparseSize > 0) {
+                                for (const uint32_t row : sparseRemoved[p]) value -= sparse[row * RowSize + i + j];
+                                for (const uint32_t row : sparseAdded  [p]) value += sparse[row * RowSize + i + j];
+                            }
+
+                            output[index + j] = value;
+                        }
+                    }
 #endif
             }
 
-            /// \brief Activate the input arrays, flatten the concatenated tensor result, and forward propagate the
-            ///        flattened result.
+            /// \brief Subtract and add rows of the delta from and to the values of both perspectives, in a single pass.
+            /// \see MantaRay::SIMD::SubtractAndAddRows for the details, without any sparse rows.
+            template<AccumulatorLayout Layout, size_t Removed, size_t Added, typename T, size_t ValueSize,
+                     size_t DeltaSize>
+            static inline void SubtractAndAddRows(const std::array<T, ValueSize>& input,
+                                                  std::array<T, ValueSize>& output,
+                                                  const std::array<T, DeltaSize>& delta,
+                                                  const std::array<std::array<uint32_t, Removed>, 2>& removed,
+                                                  const std::array<std::array<uint32_t, Added  >, 2>& added)
+            {
+                SubtractAndAddRows<Layout>(input, output, delta, removed, added, delta, {}, {});
+            }
+
+            /// \brief Activate the values of both perspectives, flatten the concatenated tensor result, and forward
+            ///        propagate the flattened result.
             /// \tparam Activation The activation function to use.
+            /// \tparam Layout The layout of the perspectives in the input array.
             /// \tparam T The type of the input, weight, and bias arrays.
             /// \tparam OT The type of the output array.
-            /// \tparam InputSize The size of the input arrays.
+            /// \tparam ValueSize The size of the input array, holding both perspectives.
             /// \tparam OutputSize The size of the output array.
-            /// \param inputA The first input array.
-            /// \param inputB The second input array.
+            /// \param input The values of both perspectives.
+            /// \param first The perspective concatenated first, such as the color to move.
             /// \param weight The weight array.
             /// \param bias The bias array.
             /// \param output The output array.
             /// \param o The offset into the output array.
-            /// \details This function activates the input arrays. Then it creates a Tensor-view of the input arrays,
-            ///          concatenating them vertically. After which, it flattens the vertical tensor into a 1D tensor.
-            ///          Finally, it forwards propagates the flattened tensor with respect to the weight and bias arrays
-            ///          using simple matrix multiplication. The result is stored in the output array starting at the
-            ///          given offset.
-            template<typename Activation, typename T, typename OT, size_t InputSize, size_t OutputSize>
-            [[clang::noinline]]
+            /// \details This function activates the values of both perspectives. Then it creates a Tensor-view of the
+            ///          perspectives, concatenating them vertically with the first perspective on top. After which, it
+            ///          flattens the vertical tensor into a 1D tensor. Finally, it forwards propagates the flattened
+            ///          tensor with respect to the weight and bias arrays using simple matrix multiplication. The
+            ///          result is stored in the output array starting at the given offset.
+            ///
+            ///          Every output (head) is accumulated in the same pass, so each input is loaded and activated
+            ///          once no matter how many outputs the network has.
+            template<typename Activation, AccumulatorLayout Layout, typename T, typename OT, size_t ValueSize,
+                     size_t OutputSize>
+            [[gnu::noinline]]
             static void ActivateFlattenAndForward(
-                    const std::array<T, InputSize>& inputA, const std::array<T, InputSize>& inputB,
-                    const std::array<T, InputSize * 2 * OutputSize>& weight,
+                    const std::array<T, ValueSize>& input, const uint8_t first,
+                    const std::array<T, ValueSize * OutputSize>& weight,
                     const std::array<T, OutputSize>& bias,
                     std::array<OT, OutputSize>& output, const uint32_t o)
             {
-                // Define the stride with respect to the weight array:
-                size_t stride = 0;
+                using Storage = PerspectiveStorage<Layout, T, ValueSize / 2>;
+
+                // Define the size of a perspective:
+                constexpr size_t InputSize = ValueSize / 2;
+
+                // Define the stride between the weights of two outputs:
+                constexpr size_t Stride = InputSize * 2;
 
                 // Perform the joint activation-flattening-forward propagation using matrix multiplication, defined as
                 // output = activation(flatten(input)) * weight + bias:
+#ifdef __AVX512BW__
+                // Define the registers for sum accumulation, one per output:
+                Vec512<OT> zmm0[OutputSize];
+                for (size_t i = 0; i < OutputSize; i++) zmm0[i] = Avx512<OT>::Zero();
+
+                // Define the registers used in the inner loop:
+                Vec512<T> zmm1;
+                Vec512<T> zmm2;
+
+                // Define the step size for the loop:
+                constexpr size_t Step = sizeof(Vec512I) / sizeof(T);
+
+                // Inner loop performing sum += activation(flatten(input)) * weight for every output:
+                for (size_t r = 0; r < InputSize; r += Storage::Run)
+#pragma GCC unroll 16
+                    for (size_t j = 0; j < Storage::Run; j += Step) {
+                        // Load and activate the input of both perspectives:
+                        zmm1 = Activation::Activate(Avx512<T>::From(input, Storage::Index(first    , r) + j));
+                        zmm2 = Activation::Activate(Avx512<T>::From(input, Storage::Index(first ^ 1, r) + j));
+
+                        // Multiply the input registers by the weights of every output and add the results to the sum
+                        // registers, performing sum += input * weight:
+#pragma GCC unroll 16
+                        for (size_t i = 0; i < OutputSize; i++) {
+                            zmm0[i] = MultiplyAndAccumulate<T, OT>(
+                                    zmm0[i], zmm1, Avx512<T>::From(weight, i * Stride + r + j));
+                            zmm0[i] = MultiplyAndAccumulate<T, OT>(
+                                    zmm0[i], zmm2, Avx512<T>::From(weight, i * Stride + InputSize + r + j));
+                        }
+                    }
+
+                // Sum up the sum accumulation registers and store the results with respect to the bias:
+                for (size_t i = 0; i < OutputSize; i++) output[o + i] = Avx512<OT>::Sum(zmm0[i]) + bias[o + i];
+#elifdef __AVX2__
+                // Define the registers for sum accumulation, one per output:
+                Vec256<OT> ymm0[OutputSize];
+                for (size_t i = 0; i < OutputSize; i++) ymm0[i] = Avx<OT>::Zero();
+
+                // Define the registers used in the inner loop:
+                Vec256<T> ymm1;
+                Vec256<T> ymm2;
+
+                // Define the step size for the loop:
+                constexpr size_t Step = sizeof(Vec256I) / sizeof(T);
+
+                // Inner loop performing sum += activation(flatten(input)) * weight for every output:
+                for (size_t r = 0; r < InputSize; r += Storage::Run)
+#pragma GCC unroll 16
+                    for (size_t j = 0; j < Storage::Run; j += Step) {
+                        // Load and activate the input of both perspectives:
+                        ymm1 = Activation::Activate(Avx<T>::From(input, Storage::Index(first    , r) + j));
+                        ymm2 = Activation::Activate(Avx<T>::From(input, Storage::Index(first ^ 1, r) + j));
+
+                        // Multiply the input registers by the weights of every output and add the results to the sum
+                        // registers, performing sum += input * weight:
+#pragma GCC unroll 16
+                        for (size_t i = 0; i < OutputSize; i++) {
+                            ymm0[i] = MultiplyAndAccumulate<T, OT>(
+                                    ymm0[i], ymm1, Avx<T>::From(weight, i * Stride + r + j));
+                            ymm0[i] = MultiplyAndAccumulate<T, OT>(
+                                    ymm0[i], ymm2, Avx<T>::From(weight, i * Stride + InputSize + r + j));
+                        }
+                    }
+
+                // Sum up the sum accumulation registers and store the results with respect to the bias:
+                for (size_t i = 0; i < OutputSize; i++) output[o + i] = Avx2<OT>::Sum(ymm0[i]) + bias[o + i];
+#else
+                // Define the sum accumulation variables, one per output:
+                std::array<OT, OutputSize> sum {};
+
+                for (size_t r = 0; r < InputSize; r += Storage::Run)
+#pragma GCC unroll 16
+                    for (size_t j = 0; j < Storage::Run; j++) {
+                        // Activate the input of both perspectives:
+                        const OT a = Activation::Activate(input[Storage::Index(first    , r) + j]);
+                        const OT b = Activation::Activate(input[Storage::Index(first ^ 1, r) + j]);
+
+                        // Add the activations multiplied by the weights of every output to the sums:
+                        for (size_t i = 0; i < OutputSize; i++) {
+                            sum[i] += a * weight[i * Stride + r + j];
+                            sum[i] += b * weight[i * Stride + InputSize + r + j];
+                        }
+                    }
+
+                // Store the sums with respect to the bias:
+                for (size_t i = 0; i < OutputSize; i++) output[o + i] = sum[i] + bias[o + i];
+#endif
+            }
+
+            /// \brief Activate, flatten, and forward-propagate a tile of accumulators, loading every weight once for
+            ///        the whole tile.
+            /// \tparam Activation The activation function to use.
+            /// \tparam Layout The layout of the perspectives in the input arrays.
+            /// \tparam Tile The number of input arrays in the tile.
+            /// \tparam T The type of the input, weight, and bias arrays.
+            /// \tparam OT The type of the output arrays.
+            /// \tparam ValueSize The size of the input arrays, holding both perspectives.
+            /// \tparam OutputSize The size of the output arrays.
+            /// \param input The values of both perspectives of every accumulator.
+            /// \param first The perspective concatenated first for every accumulator, such as its color to move.
+            /// \param weight The weight array.
+            /// \param bias The bias array.
+            /// \param output The output array of every accumulator.
+            /// \details This function computes the same result as ActivateFlattenAndForward for every accumulator of
+            ///          the tile, but as a matrix-matrix product: each weight register is loaded once and multiplied
+            ///          with the activated inputs of every accumulator, which are summed into one register per
+            ///          accumulator. The weights are thus streamed from memory once per tile rather than once per
+            ///          accumulator.
+            /// \see MantaRay::SIMD::ActivateFlattenAndForward for the single accumulator version.
+            template<typename Activation, AccumulatorLayout Layout, size_t Tile, typename T, typename OT,
+                     size_t ValueSize, size_t OutputSize>
+            [[gnu::noinline]]
+            static void ActivateFlattenAndForwardTile(
+                    const std::array<const std::array<T, ValueSize>*, Tile>& input,
+                    const std::array<uint8_t, Tile>& first,
+                    const std::array<T, ValueSize * OutputSize>& weight,
+                    const std::array<T, OutputSize>& bias,
+                    std::array<std::array<OT, OutputSize>, Tile>& output)
+            {
+                using Storage = PerspectiveStorage<Layout, T, ValueSize / 2>;
+
+                // Define the size of a perspective:
+                constexpr size_t InputSize = ValueSize / 2;
+
+                // Define the stride with respect to the weight array:
+                size_t stride = 0;
+
                 for (size_t i = 0; i < OutputSize; i++) {
 #ifdef __AVX512BW__
-                    // Define the register for sum accumulation:
-                    Vec512I zmm0 = Avx512<OT>::Zero();
+                    // Define a sum accumulation register for every accumulator:
+                    Vec512<OT> zmm0[Tile];
+                    for (size_t t = 0; t < Tile; t++) zmm0[t] = Avx512<OT>::Zero();
 
                     // Define the registers used in the inner loop:
-                    Vec512I zmm1;
-                    Vec512I zmm2;
+                    Vec512<T> zmm1;
+                    Vec512<T> zmm2;
+                    Vec512<T> zmm3;
 
                     // Define the step size for the loop:
                     constexpr size_t Step = sizeof(Vec512I) / sizeof(T);
 
-                    // Inner loop performing sum += activation(flatten(input)) * weight:
-                    for (size_t j = 0; j < InputSize; j += Step) {
-                        //region INPUT A
-                        // Load the input array and weight array into registers:
-                        zmm1 = Avx512<T> ::From(inputA, j);
-                        zmm2 = Avx512<T> ::From(weight, stride + j);
-
-                        // Activate the input register:
-                        zmm1 = Activation::Activate(zmm1);
-
-                        // Multiply the input register by the weight register and add the result to the sum register,
-                        // performing sum += input * weight:
-                        zmm1 = Avx512<T> ::MultiplyAndAddAdjacent(zmm1, zmm2);
-                        zmm0 = Avx512<OT>::Add(zmm0, zmm1);
-                        //endregion
-
-                        //region INPUT B
-                        // Load the input array and weight array into registers:
-                        zmm1 = Avx512<T> ::From(inputB, j);
-                        zmm2 = Avx512<T> ::From(weight, InputSize + stride + j);
-
-                        // Activate the input register:
-                        zmm1 = Activation::Activate(zmm1);
-
-                        // Multiply the input register by the weight register and add the result to the sum register,
-                        // performing sum += input * weight:
-                        zmm1 = Avx512<T> ::MultiplyAndAddAdjacent(zmm1, zmm2);
-                        zmm0 = Avx512<OT>::Add(zmm0, zmm1);
-                        //endregion
-                    }
+                    // Inner loop performing sum += activation(flatten(input)) * weight for every accumulator:
+                    for (size_t r = 0; r < InputSize; r += Storage::Run)
+#pragma GCC unroll 16
+                        for (size_t j = 0; j < Storage::Run; j += Step) {
+                            // Load the weights of both perspectives once for the whole tile:
+                            zmm1 = Avx512<T>::From(weight,             stride + r + j);
+                            zmm2 = Avx512<T>::From(weight, InputSize + stride + r + j);
+
+                            // Keep the sums of the tile in registers by fully unrolling over it:
+#pragma GCC unroll 16
+                            for (size_t t = 0; t < Tile; t++) {
+                                //region INPUT A
+                                zmm3 = Avx512<T>::From(*input[t], Storage::Index(first[t], r) + j);
+                                zmm3 = Activation::Activate(zmm3);
+                                zmm0[t] = MultiplyAndAccumulate<T, OT>(zmm0[t], zmm3, zmm1);
+                                //endregion
+
+                                //region INPUT B
+                                zmm3 = Avx512<T>::From(*input[t], Storage::Index(first[t] ^ 1, r) + j);
+                                zmm3 = Activation::Activate(zmm3);
+                                zmm0[t] = MultiplyAndAccumulate<T, OT>(zmm0[t], zmm3, zmm2);
+                                //endregion
+                            }
+                        }
 
                     stride += InputSize * 2;
 
-                    output[o + i] = Avx512<OT>::Sum(zmm0) + bias[o + i];
+                    for (size_t t = 0; t < Tile; t++) output[t][i] = Avx512<OT>::Sum(zmm0[t]) + bias[i];
 #elifdef __AVX2__
-                    // Define the register for sum accumulation:
-                    Vec256I ymm0 = Avx<OT>::Zero();
+                    // Define a sum accumulation register for every accumulator:
+                    Vec256<OT> ymm0[Tile];
+                    for (size_t t = 0; t < Tile; t++) ymm0[t] = Avx<OT>::Zero();
 
                     // Define the registers used in the inner loop:
-                    Vec256I ymm1;
-                    Vec256I ymm2;
+                    Vec256<T> ymm1;
+                    Vec256<T> ymm2;
+                    Vec256<T> ymm3;
 
                     // Define the step size for the loop:
                     constexpr size_t Step = sizeof(Vec256I) / sizeof(T);
 
-                    // Inner loop performing sum += activation(flatten(input)) * weight:
-                    for (size_t j = 0; j < InputSize; j += Step) {
-                        //region INPUT A
-                        // Load the input array and weight array into registers:
-                        ymm1 = Avx<T>    ::From(inputA,          j);
-                        ymm2 = Avx<T>    ::From(weight, stride + j);
-
-                        // Activate the input register:
-                        ymm1 = Activation::Activate(ymm1);
-
-                        // Multiply the input register by the weight register and add the result to the sum register,
-                        // performing sum += input * weight:
-                        ymm1 = Avx2<T>   ::MultiplyAndAddAdjacent(ymm1, ymm2);
-                        ymm0 = Avx2<OT>  ::Add(ymm0, ymm1);
-                        //endregion
-
-                        //region INPUT B
-                        // Load the input array and weight array into registers:
-                        ymm1 = Avx<T>    ::From(inputB,                      j);
-                        ymm2 = Avx<T>    ::From(weight, InputSize + stride + j);
-
-                        // Activate the input register:
-                        ymm1 = Activation::Activate(ymm1);
-
-                        // Multiply the input register by the weight register and add the result to the sum register,
-                        // performing sum += input * weight:
-                        ymm1 = Avx2<T>   ::MultiplyAndAddAdjacent(ymm1, ymm2);
-                        ymm0 = Avx2<OT>  ::Add(ymm0, ymm1);
-                        //endregion
-                    }
+                    // Inner loop performing sum += activation(flatten(input)) * weight for every accumulator:
+                    for (size_t r = 0; r < InputSize; r += Storage::Run)
+#pragma GCC unroll 16
+                        for (size_t j = 0; j < Storage::Run; j += Step) {
+                            // Load the weights of both perspectives once for the whole tile:
+                            ymm1 = Avx<T>::From(weight,             stride + r + j);
+                            ymm2 = Avx<T>::From(weight, InputSize + stride + r + j);
+
+                            // Keep the sums of the tile in registers by fully unrolling over it:
+#pragma GCC unroll 16
+                            for (size_t t = 0; t < Tile; t++) {
+                                //region INPUT A
+                                ymm3 = Avx<T>::From(*input[t], Storage::Index(first[t], r) + j);
+                                ymm3 = Activation::Activate(ymm3);
+                                ymm0[t] = MultiplyAndAccumulate<T, OT>(ymm0[t], ymm3, ymm1);
+                                //endregion
+
+                                //region INPUT B
+                                ymm3 = Avx<T>::From(*input[t], Storage::Index(first[t] ^ 1, r) + j);
+                                ymm3 = Activation::Activate(ymm3);
+                                ymm0[t] = MultiplyAndAccumulate<T, OT>(ymm0[t], ymm3, ymm2);
+                                //endregion
+                            }
+                        }
 
                     // Stride to the next set of weights:
                     stride += InputSize * 2;
 
-                    // Sum up the sum accumulation register and store the result with respect to the bias:
-                    output[o + i] = Avx2<OT>::Sum(ymm0) + bias[o + i];
+                    // Sum up the sum accumulation registers and store the results with respect to the bias:
+                    for (size_t t = 0; t < Tile; t++) output[t][i] = Avx2<OT>::Sum(ymm0[t]) + bias[i];
 #else
-                    // Define the sum accumulation variable:
-                    OT sum = 0;
-
-                    for (size_t j = 0; j < InputSize; j++) {
-                        // Add the activation of the input multiplied by the weight to the sum:
-                        sum += Activation::Activate(inputA[j]) * weight[stride + j];
-                        sum += Activation::Activate(inputB[j]) * weight[InputSize + stride + j];
-                    }
+                    // Define the sum accumulation variables:
+                    std::array<OT, Tile> sum {};
+
+                    for (size_t r = 0; r < InputSize; r += Storage::Run)
+#pragma GCC unroll 16
+                        for (size_t j = 0; j < Storage::Run; j++) {
+                            // Load the weights of both perspectives once for the whole tile:
+                            const OT weightA = weight[            stride + r + j];
+                            const OT weightB = weight[InputSize + stride + r + j];
+
+                            // Keep the sums of the tile in registers by fully unrolling over it:
+#pragma GCC unroll 16
+                            for (size_t t = 0; t < Tile; t++) {
+                                sum[t] += Activation::Activate((*input[t])[Storage::Index(first[t]    , r) + j]) *
+                                          weightA;
+                                sum[t] += Activation::Activate((*input[t])[Storage::Index(first[t] ^ 1, r) + j]) *
+                                          weightB;
+                            }
+                        }
 
                     // Stride to the next set of weights:
                     stride += InputSize * 2;
 
-                    // Store the sum with respect to the bias:
-                    output[o + i] = sum + bias[o + i];
+                    // Store the sums with respect to the bias:
+                    for (size_t t = 0; t < Tile; t++) output[t][i] = sum[t] + bias[i];
 #endif
                 }
             }
 
+            /// \brief Quantize floating-point values into 16-bit integers.
+            /// \tparam T The quantized type.
+            /// \param input The floating-point values.
+            /// \param output The quantized values.
+            /// \param size The number of values.
+            /// \param K The Quantization factor.
+            /// \details This function multiplies the input by the quantization factor, truncates it towards zero
+            ///          (as MantaRay::MarlinflowStream does) and saturates it to the range of the quantized type.
+            ///          Neither the input nor the output needs to be aligned.
+            template<typename T>
+            static inline void Quantize(const float* input, T* output, const size_t size, const float K)
+            {
+                static_assert(std::is_same_v<T, int16_t>, "Unsupported type provided.");
+
+                size_t i = 0;
+
+#ifdef __AVX512BW__
+                // Define the registers used in the loop:
+                const Vec512F k = Avx512<float>::From(K);
+                Vec512I zmm0;
+                Vec512I zmm1;
+
+                // Define the step size for the loop:
+                constexpr size_t Step = sizeof(Vec512I) / sizeof(T);
+
+                for (; i + Step <= size; i += Step) {
+                    // Load, scale and truncate both halves of the input into 32-bit integer registers:
+                    zmm0 = Avx512<float>::ConvertToInt32(
+                            Avx512<float>::Multiply(Avx512<float>::FromUnaligned(input + i           ), k));
+                    zmm1 = Avx512<float>::ConvertToInt32(
+                            Avx512<float>::Multiply(Avx512<float>::FromUnaligned(input + i + Step / 2), k));
+
+                    // Saturate both halves into a single register and store it:
+                    Avx512<T>::StoreUnaligned(Avx512<int32_t>::Pack(zmm0, zmm1), output + i);
+                }
+#elifdef __AVX2__
+                // Define the registers used in the loop:
+                const Vec256F k = Avx<float>::From(K);
+                Vec256I ymm0;
+                Vec256I ymm1;
+
+                // Define the step size for the loop:
+                constexpr size_t Step = sizeof(Vec256I) / sizeof(T);
+
+                for (; i + Step <= size; i += Step) {
+                    // Load, scale and truncate both halves of the input into 32-bit integer registers:
+                    ymm0 = Avx<float>::ConvertToInt32(
+                            Avx<float>::Multiply(Avx<float>::FromUnaligned(input + i           ), k));
+                    ymm1 = Avx<float>::ConvertToInt32(
+                            Avx<float>::Multiply(Avx<float>::FromUnaligned(input + i + Step / 2), k));
+
+                    // Saturate both halves into a single register and store it:
+                    Avx<T>::StoreUnaligned(Avx2<int32_t>::Pack(ymm0, ymm1), output + i);
+                }
+#endif
+                // Quantize the remaining values:
+                constexpr float Minimum = std::numeric_limits<T>::min();
+                constexpr float Maximum = std::numeric_limits<T>::max();
+                for (; i < size; i++) output[i] = static_cast<T>(std::clamp(std::trunc(input[i] * K), Minimum,
+                                                                            Maximum));
+            }
+
     };
 } // MantaRay
 
@@ -0,0 +1,137 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#include "Perspective/PerspectiveNNUE.h"
+#include "Activation/ClippedReLU.h"
+#include "Service/EvaluationServer.h"
+#include "CommandLine.h"
+
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+#include <pthread.h>
+
+// Local evaluation service sharing a single network between any number of clients.
+
+using Network = MantaRay::PerspectiveNetwork<int16_t, int32_t, MantaRay::ClippedReLU<int16_t, 0, 255>,
+                                             768, 256, 1, 512, 400, 255, 64>;
+
+struct ServerRunnerOptions
+{
+
+    std::string Network;
+    std::string Socket;
+
+    bool MarlinflowNetwork = false;
+
+    MantaRay::EvaluationServerOptions Server;
+
+};
+
+void PrintUsage()
+{
+    std::cout << "Usage: MantaRayServer --network <network> --socket <path> [options]"   << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --format <format>        Network format: binary (default) or marlinflow."      << std::endl;
+    std::cout << "  --threads <count>        Worker threads (default: all cores)."                 << std::endl;
+    std::cout << "  --batch <size>           Positions evaluated together (default 256)."          << std::endl;
+    std::cout << "  --window <microseconds>  Wait for other clients' requests (default 200)."      << std::endl;
+}
+
+bool ParseOptions(const int argc, char** argv, ServerRunnerOptions& options)
+{
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+
+        // Every option takes exactly one value:
+        if (i + 1 >= argc) return false;
+        const std::string value = argv[++i];
+
+        size_t window;
+        if      (arg == "--network") options.Network = value;
+        else if (arg == "--socket" ) options.Socket  = value;
+        else if (arg == "--threads") {
+            if (!MantaRay::CommandLine::ParseCount(value, options.Server.Threads  , 1, 1 << 12)) return false;
+        }
+        else if (arg == "--batch"  ) {
+            if (!MantaRay::CommandLine::ParseCount(value, options.Server.BatchSize, 1, 1 << 20)) return false;
+        }
+        else if (arg == "--window" ) {
+            // A window of zero evaluates every request as soon as it arrives, and a second is already absurd:
+            if (!MantaRay::CommandLine::ParseCount(value, window                  , 0, 1000000)) return false;
+            options.Server.Window = std::chrono::microseconds(window);
+        }
+        else if (arg == "--format" ) {
+            if      (value == "binary"    ) options.MarlinflowNetwork = false;
+            else if (value == "marlinflow") options.MarlinflowNetwork = true ;
+            else return false;
+        }
+        else return false;
+    }
+
+    return !options.Network.empty() && !options.Socket.empty();
+}
+
+int main(const int argc, char** argv)
+{
+    ServerRunnerOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::unique_ptr<Network> network;
+    try {
+        if (options.MarlinflowNetwork) {
+            MantaRay::MarlinflowStream stream(options.Network);
+            network = std::make_unique<Network>(stream);
+        } else {
+            MantaRay::BinaryFileStream stream(options.Network);
+            network = std::make_unique<Network>(stream);
+
+            // Binary networks are read as is, so a missing or mis-shaped file has to be caught here:
+            if (!stream.Good() || !stream.Finished())
+                throw std::runtime_error("The file is missing or doesn't match the shape of the network.");
+        }
+    } catch (const std::exception& exception) {
+        std::cerr << "Failed to load " << options.Network << ": " << exception.what() << std::endl;
+        return 1;
+    }
+
+    MantaRay::EvaluationServer<Network> server(*network, options.Server);
+
+    // Stopping the server isn't signal-safe, so the signals are blocked in every thread and waited for by one:
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT );
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    std::thread([&server, signals] {
+        int signal;
+        sigwait(&signals, &signal);
+        server.Stop();
+    }).detach();
+
+    std::cout << "Serving " << options.Network << " on " << options.Socket << "." << std::endl;
+    if (!server.Run(options.Socket)) {
+        std::cerr << "Failed to listen on " << options.Socket << "." << std::endl;
+        return 1;
+    }
+
+    const MantaRay::ServiceStatistics statistics = server.Statistics();
+    std::cout << "Served " << statistics.Requests << " requests." << std::endl;
+    std::cout << " | Positions            : " << statistics.Positions                << std::endl;
+    std::cout << " | Batches              : " << statistics.Batches                  << std::endl;
+    std::cout << " | Average latency (us) : " << statistics.AverageLatency()         << std::endl;
+    std::cout << " | Max latency (us)     : " << statistics.MaxLatency / 1000        << std::endl;
+    std::cout << " | Positions per second : " << statistics.PositionsPerSecond()     << std::endl;
+    return 0;
+}
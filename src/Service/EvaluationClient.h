@@ -0,0 +1,174 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_EVALUATIONCLIENT_H
+#define MANTARAY_EVALUATIONCLIENT_H
+
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <string_view>
+
+#include <sys/un.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "EvaluationProtocol.h"
+
+namespace MantaRay
+{
+
+    /// \brief A client of a MantaRay::EvaluationServer.
+    /// \details A client holds a single connection and sends one request at a time. Threads that evaluate
+    ///          concurrently should use a client each, which lets the server coalesce their requests.
+    class EvaluationClient
+    {
+
+        public:
+            /// \brief A piece of a position sent as a piece list.
+            struct PieceSquare
+            {
+                uint8_t Piece;
+                uint8_t Color;
+                uint8_t Square;
+            };
+
+            /// \brief A position sent as a piece list.
+            struct Position
+            {
+                std::span<const PieceSquare> Pieces;
+                uint8_t                      ColorToMove;
+            };
+
+        private:
+            int Socket = -1;
+
+            std::string Payload;
+
+            /// \brief Send a request and receive its response.
+            /// \return Whether the server answered the request successfully.
+            bool Exchange(const RequestType type)
+            {
+                if (Socket < 0 || !EvaluationProtocol::WriteMessage(Socket, static_cast<uint8_t>(type), Payload))
+                    return false;
+
+                uint8_t status;
+                return EvaluationProtocol::ReadMessage(Socket, status, Payload) &&
+                       status == static_cast<uint8_t>(ResponseStatus::Ok);
+            }
+
+            /// \brief Decode the scores of an evaluation response.
+            bool DecodeScores(std::vector<int32_t>& scores) const
+            {
+                std::string_view payload = Payload;
+
+                uint32_t count;
+                if (!EvaluationProtocol::Take(payload, count) || payload.size() != count * sizeof(int32_t))
+                    return false;
+
+                scores.resize(count);
+                for (int32_t& score : scores) EvaluationProtocol::Take(payload, score);
+                return true;
+            }
+
+        public:
+            /// \brief Constructs a new EvaluationClient connected to a server.
+            /// \param path The path of the socket of the server.
+            /// \details Good() tells whether the client could connect.
+            __attribute__((unused)) explicit EvaluationClient(const std::string& path)
+            {
+                sockaddr_un address {};
+                address.sun_family = AF_UNIX;
+                if (path.size() >= sizeof(address.sun_path)) return;
+                std::copy(path.begin(), path.end(), address.sun_path);
+
+                Socket = socket(AF_UNIX, SOCK_STREAM, 0);
+                if (Socket >= 0 && connect(Socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                    close(Socket);
+                    Socket = -1;
+                }
+            }
+
+            EvaluationClient(const EvaluationClient&) = delete;
+            EvaluationClient& operator=(const EvaluationClient&) = delete;
+
+            ~EvaluationClient()
+            {
+                if (Socket >= 0) close(Socket);
+            }
+
+            /// \brief Whether the client is connected.
+            [[nodiscard]] __attribute__((unused)) bool Good() const
+            {
+                return Socket >= 0;
+            }
+
+            /// \brief Evaluate a batch of FEN strings.
+            /// \param fens The FEN strings.
+            /// \param scores The score of every position from the point of view of the color to move, or
+            ///               MantaRay::EvaluationProtocol::InvalidScore for positions that couldn't be evaluated.
+            /// \return Whether the server answered.
+            __attribute__((unused)) bool Evaluate(const std::span<const std::string_view> fens,
+                                                  std::vector<int32_t>& scores)
+            {
+                Payload.clear();
+                EvaluationProtocol::Append(Payload, static_cast<uint32_t>(fens.size()));
+                for (const std::string_view fen : fens) {
+                    EvaluationProtocol::Append(Payload, static_cast<uint16_t>(fen.size()));
+                    Payload += fen;
+                }
+
+                return Exchange(RequestType::Fens) && DecodeScores(scores);
+            }
+
+            /// \brief Evaluate a batch of piece lists.
+            /// \param positions The positions, with no more than 255 pieces each.
+            /// \param scores The score of every position from the point of view of the color to move, or
+            ///               MantaRay::EvaluationProtocol::InvalidScore for positions that couldn't be evaluated.
+            /// \return Whether the server answered.
+            __attribute__((unused)) bool Evaluate(const std::span<const Position> positions,
+                                                  std::vector<int32_t>& scores)
+            {
+                Payload.clear();
+                EvaluationProtocol::Append(Payload, static_cast<uint32_t>(positions.size()));
+                for (const Position& position : positions) {
+                    EvaluationProtocol::Append(Payload, position.ColorToMove);
+                    EvaluationProtocol::Append(Payload, static_cast<uint8_t>(position.Pieces.size()));
+
+                    for (const PieceSquare& piece : position.Pieces) {
+                        EvaluationProtocol::Append(Payload, piece.Piece );
+                        EvaluationProtocol::Append(Payload, piece.Color );
+                        EvaluationProtocol::Append(Payload, piece.Square);
+                    }
+                }
+
+                return Exchange(RequestType::Features) && DecodeScores(scores);
+            }
+
+            /// \brief Request the counters of the server.
+            /// \param statistics The counters.
+            /// \return Whether the server answered.
+            __attribute__((unused)) bool Statistics(ServiceStatistics& statistics)
+            {
+                Payload.clear();
+                if (!Exchange(RequestType::Statistics)) return false;
+
+                std::string_view payload = Payload;
+                return EvaluationProtocol::Take(payload, statistics.Requests    ) &&
+                       EvaluationProtocol::Take(payload, statistics.Positions   ) &&
+                       EvaluationProtocol::Take(payload, statistics.Batches     ) &&
+                       EvaluationProtocol::Take(payload, statistics.TotalLatency) &&
+                       EvaluationProtocol::Take(payload, statistics.MaxLatency  ) &&
+                       EvaluationProtocol::Take(payload, statistics.Uptime      ) &&
+                       EvaluationProtocol::Take(payload, statistics.Clients     );
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_EVALUATIONCLIENT_H
@@ -0,0 +1,197 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_EVALUATIONPROTOCOL_H
+#define MANTARAY_EVALUATIONPROTOCOL_H
+
+#include <string>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include <unistd.h>
+#include <sys/socket.h>
+
+namespace MantaRay
+{
+
+    /// \brief The type of a request to a MantaRay::EvaluationServer.
+    enum class RequestType : uint8_t
+    {
+        /// \brief A batch of FEN strings.
+        Fens,
+        /// \brief A batch of piece lists.
+        Features,
+        /// \brief The counters of the server.
+        Statistics
+    };
+
+    /// \brief The status of a response of a MantaRay::EvaluationServer.
+    enum class ResponseStatus : uint8_t
+    {
+        Ok,
+        /// \brief The request couldn't be decoded.
+        Malformed
+    };
+
+    /// \brief The counters of a MantaRay::EvaluationServer.
+    struct ServiceStatistics
+    {
+
+        /// \brief The number of evaluation requests answered.
+        uint64_t Requests = 0;
+
+        /// \brief The number of positions evaluated.
+        uint64_t Positions = 0;
+
+        /// \brief The number of batches evaluated, which span the requests of any number of clients.
+        uint64_t Batches = 0;
+
+        /// \brief The sum and the maximum of the time between receiving a request and answering it, in nanoseconds.
+        uint64_t TotalLatency = 0;
+        uint64_t MaxLatency   = 0;
+
+        /// \brief The time since the server started, in nanoseconds.
+        uint64_t Uptime = 0;
+
+        /// \brief The number of connected clients.
+        uint64_t Clients = 0;
+
+        /// \brief The average latency of a request, in microseconds.
+        [[nodiscard]] __attribute__((unused)) double AverageLatency() const
+        {
+            return Requests > 0 ? static_cast<double>(TotalLatency) / static_cast<double>(Requests) / 1000.0 : 0;
+        }
+
+        /// \brief The number of positions evaluated per second since the server started.
+        [[nodiscard]] __attribute__((unused)) double PositionsPerSecond() const
+        {
+            return Uptime > 0 ? static_cast<double>(Positions) * 1e9 / static_cast<double>(Uptime) : 0;
+        }
+
+    };
+
+    /// \brief The wire format of the evaluation service.
+    /// \details Every message is framed as a 32-bit payload size followed by a type byte (a MantaRay::RequestType for
+    ///          requests, a MantaRay::ResponseStatus for responses) and the payload. All integers are little-endian,
+    ///          as the service only ever talks to the local machine.
+    ///
+    ///          - Fens request: a 32-bit position count, then every FEN as a 16-bit length followed by its bytes.
+    ///          - Features request: a 32-bit position count, then every position as the color to move, a piece count
+    ///            and that many (piece, color, square) byte triples.
+    ///          - Statistics request: an empty payload.
+    ///          - Evaluation response: a 32-bit position count, then a 32-bit score for every position from the point
+    ///            of view of the color to move, or InvalidScore for positions that couldn't be decoded.
+    ///          - Statistics response: the fields of MantaRay::ServiceStatistics as 64-bit integers, in order.
+    class EvaluationProtocol
+    {
+
+        public:
+            /// \brief The largest payload accepted.
+            constexpr static uint32_t MaxPayload = 64 << 20;
+
+            /// \brief The score of a position that couldn't be decoded.
+            constexpr static int32_t InvalidScore = INT32_MIN;
+
+            /// \brief Read exactly the given number of bytes from a socket.
+            static bool ReadExact(const int socket, void* data, size_t size)
+            {
+                auto* bytes = static_cast<char*>(data);
+                while (size > 0) {
+                    const ssize_t read = recv(socket, bytes, size, 0);
+                    if (read < 0 && errno == EINTR) continue;
+                    if (read <= 0) return false;
+
+                    bytes += read;
+                    size  -= read;
+                }
+
+                return true;
+            }
+
+            /// \brief Write exactly the given number of bytes to a socket.
+            static bool WriteExact(const int socket, const void* data, size_t size)
+            {
+                const auto* bytes = static_cast<const char*>(data);
+                while (size > 0) {
+                    const ssize_t written = send(socket, bytes, size, MSG_NOSIGNAL);
+                    if (written < 0 && errno == EINTR) continue;
+                    if (written <= 0) return false;
+
+                    bytes += written;
+                    size  -= written;
+                }
+
+                return true;
+            }
+
+            /// \brief Read a message from a socket.
+            /// \param socket The socket.
+            /// \param type The type byte of the message.
+            /// \param payload The payload of the message.
+            /// \return Whether a whole message was read.
+            static bool ReadMessage(const int socket, uint8_t& type, std::string& payload)
+            {
+                uint32_t size;
+                if (!ReadExact(socket, &size, sizeof(size)) || size > MaxPayload) return false;
+                if (!ReadExact(socket, &type, sizeof(type))) return false;
+
+                payload.resize(size);
+                return ReadExact(socket, payload.data(), size);
+            }
+
+            /// \brief Write a message to a socket.
+            /// \param socket The socket.
+            /// \param type The type byte of the message.
+            /// \param payload The payload of the message.
+            /// \return Whether the whole message was written.
+            static bool WriteMessage(const int socket, const uint8_t type, const std::string_view payload)
+            {
+                // Write the header and the payload at once, so small messages go out in a single packet:
+                std::string message(sizeof(uint32_t) + sizeof(uint8_t), '\0');
+                const auto size = static_cast<uint32_t>(payload.size());
+                std::memcpy(message.data(), &size, sizeof(size));
+                message[sizeof(size)] = static_cast<char>(type);
+                message += payload;
+
+                return WriteExact(socket, message.data(), message.size());
+            }
+
+            /// \brief Append a value to a payload.
+            template<typename T>
+            static void Append(std::string& payload, const T value)
+            {
+                payload.append(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+
+            /// \brief Take a value from the front of a payload.
+            /// \return Whether the payload held the value.
+            template<typename T>
+            static bool Take(std::string_view& payload, T& value)
+            {
+                if (payload.size() < sizeof(T)) return false;
+
+                std::memcpy(&value, payload.data(), sizeof(T));
+                payload.remove_prefix(sizeof(T));
+                return true;
+            }
+
+            /// \brief Take a number of bytes from the front of a payload.
+            /// \return Whether the payload held the bytes.
+            static bool Take(std::string_view& payload, const size_t size, std::string_view& bytes)
+            {
+                if (payload.size() < size) return false;
+
+                bytes = payload.substr(0, size);
+                payload.remove_prefix(size);
+                return true;
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_EVALUATIONPROTOCOL_H
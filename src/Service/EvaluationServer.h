@@ -0,0 +1,519 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_EVALUATIONSERVER_H
+#define MANTARAY_EVALUATIONSERVER_H
+
+#include <list>
+#include <span>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <string_view>
+#include <unordered_set>
+#include <condition_variable>
+
+#include <sys/un.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "EvaluationProtocol.h"
+#include "../Pipeline/WorkStealingPool.h"
+#include "../Perspective/Position.h"
+#include "../Memory/AlignedAllocator.h"
+
+namespace MantaRay
+{
+
+    /// \brief The options of a MantaRay::EvaluationServer.
+    struct EvaluationServerOptions
+    {
+
+        /// \brief The number of worker threads evaluating batches.
+        size_t Threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+        /// \brief The number of positions refreshed and evaluated together by a worker.
+        size_t BatchSize = 256;
+
+        /// \brief The largest number of positions coalesced into a single round of batches.
+        size_t MaxCoalesced = 1 << 16;
+
+        /// \brief How long a request waits for the requests of other clients to join its round.
+        std::chrono::microseconds Window = std::chrono::microseconds(200);
+
+    };
+
+    /// \brief A server evaluating positions for any number of local clients over a Unix domain socket.
+    /// \tparam Network The network to evaluate with, such as MantaRay::PerspectiveNetwork.
+    /// \details Clients send batches of FENs or piece lists in the format of MantaRay::EvaluationProtocol, and every
+    ///          connection is served by its own thread, which decodes the requests of the connection. A single
+    ///          batcher coalesces the pending requests of all clients into a round, waiting up to the window for
+    ///          other clients to join unless every client is already waiting, and splits the round into batches that
+    ///          are refreshed and evaluated on a work-stealing pool. The network is shared by every client, and every
+    ///          worker owns its accumulators.
+    template<typename Network>
+    class EvaluationServer
+    {
+
+        private:
+            using Accumulator = typename Network::Accumulator;
+
+            using OutputType = decltype(std::declval<const Network&>().Evaluate(std::declval<const Accumulator&>(),
+                                                                                0));
+
+            using Clock = std::chrono::steady_clock;
+
+            /// \brief A decoded evaluation request.
+            struct Request
+            {
+
+                std::vector<Position> Positions;
+                std::vector<uint8_t > Valid;
+                std::vector<int32_t > Scores;
+
+                // The number of valid positions:
+                size_t Evaluable = 0;
+
+                bool Done = false;
+
+            };
+
+            /// \brief A position of a request.
+            struct Entry
+            {
+                Request* Owner;
+                uint32_t Index;
+            };
+
+            /// \brief The state owned by a worker thread.
+            struct Worker
+            {
+
+                std::vector<Accumulator, AlignedAllocator<Accumulator>> Accumulators;
+                std::vector<const Accumulator*> Pointers;
+
+                std::vector<Position  > Positions;
+                std::vector<uint8_t   > ColorsToMove;
+                std::vector<OutputType> Scores;
+
+            };
+
+            const Network* Net;
+
+            EvaluationServerOptions Options;
+
+            mutable std::mutex      Lock;
+            std::condition_variable Arrived;
+            std::condition_variable Completed;
+
+            std::deque<Request*> Queue;
+            size_t QueuedPositions = 0;
+
+            bool Stopping = false;
+            int  Listener = -1;
+
+            // The sockets of the connected clients, and the connection threads that finished:
+            std::unordered_set<int>      Connections;
+            std::vector<std::thread::id> Finished;
+
+            Clock::time_point Started = Clock::now();
+
+            std::atomic<uint64_t> Requests     = 0;
+            std::atomic<uint64_t> Positions    = 0;
+            std::atomic<uint64_t> Batches      = 0;
+            std::atomic<uint64_t> TotalLatency = 0;
+            std::atomic<uint64_t> MaxLatency   = 0;
+
+            /// \brief Decode an evaluation request.
+            /// \param type The type of the request.
+            /// \param payload The payload of the request.
+            /// \param request The decoded request.
+            /// \return Whether the request could be decoded. Positions that can't be evaluated don't fail the request.
+            static bool Decode(const RequestType type, std::string_view payload, Request& request)
+            {
+                request.Positions.clear();
+                request.Valid    .clear();
+                request.Evaluable = 0;
+                request.Done      = false;
+
+                uint32_t count;
+                if (!EvaluationProtocol::Take(payload, count)) return false;
+
+                // Every position takes at least two bytes, which bounds the count before anything is allocated:
+                if (count > payload.size() / 2) return false;
+
+                request.Positions.reserve(count);
+                request.Valid    .reserve(count);
+
+                for (uint32_t i = 0; i < count; i++) {
+                    Position position;
+                    bool valid;
+
+                    if (type == RequestType::Fens) {
+                        uint16_t length;
+                        std::string_view fen;
+                        if (!EvaluationProtocol::Take(payload, length) ||
+                            !EvaluationProtocol::Take(payload, length, fen)) return false;
+
+                        valid = Position::FromFen(fen, position);
+                    } else {
+                        uint8_t pieces;
+                        std::string_view bytes;
+                        if (!EvaluationProtocol::Take(payload, position.ColorToMove) ||
+                            !EvaluationProtocol::Take(payload, pieces) ||
+                            !EvaluationProtocol::Take(payload, pieces * size_t(3), bytes)) return false;
+
+                        valid = true;
+                        for (size_t p = 0; p < pieces; p++) {
+                            const auto piece  = static_cast<uint8_t>(bytes[p * 3    ]);
+                            const auto color  = static_cast<uint8_t>(bytes[p * 3 + 1]);
+                            const auto square = static_cast<uint8_t>(bytes[p * 3 + 2]);
+
+                            if (piece >= 6 || color >= 2 || square >= 64) {
+                                valid = false;
+                                break;
+                            }
+
+                            position.Bitboards[color * 6 + piece] |= 1ULL << square;
+                        }
+
+                        // Pieces sharing a square are caught here:
+                        valid = valid && position.Valid();
+                    }
+
+                    request.Positions.push_back(position);
+                    request.Valid    .push_back(valid);
+                    request.Evaluable += valid;
+                }
+
+                request.Scores.assign(count, EvaluationProtocol::InvalidScore);
+
+                return payload.empty();
+            }
+
+            /// \brief Encode the response to an evaluation request.
+            static std::string Encode(const Request& request)
+            {
+                std::string payload;
+                payload.reserve(sizeof(uint32_t) * (request.Scores.size() + 1));
+
+                EvaluationProtocol::Append(payload, static_cast<uint32_t>(request.Scores.size()));
+                for (const int32_t score : request.Scores) EvaluationProtocol::Append(payload, score);
+
+                return payload;
+            }
+
+            /// \brief Refresh and evaluate a batch of positions.
+            /// \param worker The worker evaluating the batch.
+            /// \param entries The positions, no more than the batch size.
+            void Evaluate(Worker& worker, const std::span<const Entry> entries) const
+            {
+                const size_t count = entries.size();
+
+                for (size_t i = 0; i < count; i++) {
+                    const Request& request = *entries[i].Owner;
+                    const uint32_t index   = entries[i].Index;
+
+                    worker.Positions   [i] = request.Positions[index];
+                    worker.ColorsToMove[i] = request.Positions[index].ColorToMove;
+                }
+
+                Net->RefreshBatch(std::span<const Position>(worker.Positions.data(), count),
+                                  std::span(worker.Accumulators.data(), count));
+                Net->EvaluateBatch(std::span(worker.Pointers.data(), count),
+                                   std::span(worker.ColorsToMove.data(), count),
+                                   std::span(worker.Scores.data(), count));
+
+                // Every position belongs to exactly one batch, so the scores can be written without synchronization:
+                for (size_t i = 0; i < count; i++)
+                    entries[i].Owner->Scores[entries[i].Index] = static_cast<int32_t>(worker.Scores[i]);
+            }
+
+            /// \brief The loop coalescing the requests of all clients into batches.
+            void Batch()
+            {
+                WorkStealingPool pool(Options.Threads);
+
+                std::vector<Worker> workers(pool.Threads());
+                for (Worker& worker : workers) {
+                    worker.Accumulators.resize(Options.BatchSize);
+                    worker.Positions   .resize(Options.BatchSize);
+                    worker.ColorsToMove.resize(Options.BatchSize);
+                    worker.Scores      .resize(Options.BatchSize);
+
+                    for (const Accumulator& accumulator : worker.Accumulators) worker.Pointers.push_back(&accumulator);
+                }
+
+                std::vector<Request*> round;
+                std::vector<Entry   > entries;
+
+                while (true) {
+                    {
+                        std::unique_lock<std::mutex> guard(Lock);
+                        Arrived.wait(guard, [this] { return Stopping || !Queue.empty(); });
+                        if (Queue.empty()) return;
+
+                        // Give the other clients a window to join the round, unless there's no one left to wait for
+                        // or already enough work for every worker:
+                        Arrived.wait_until(guard, Clock::now() + Options.Window, [this, &workers] {
+                            return Stopping || Queue.size() >= Connections.size() ||
+                                   QueuedPositions >= workers.size() * Options.BatchSize;
+                        });
+
+                        // Take whole requests, at least one, up to the largest round:
+                        size_t taken = 0;
+                        while (!Queue.empty() && (round.empty() ||
+                                                  taken + Queue.front()->Evaluable <= Options.MaxCoalesced)) {
+                            taken += Queue.front()->Evaluable;
+                            round.push_back(Queue.front());
+                            Queue.pop_front();
+                        }
+
+                        QueuedPositions -= taken;
+                    }
+
+                    for (Request* request : round)
+                        for (uint32_t i = 0; i < request->Valid.size(); i++)
+                            if (request->Valid[i]) entries.push_back({ request, i });
+
+                    for (size_t start = 0; start < entries.size(); start += Options.BatchSize) {
+                        const std::span<const Entry> batch(entries.data() + start,
+                                                           std::min(Options.BatchSize, entries.size() - start));
+
+                        pool.Submit([this, &workers, batch](const size_t worker) {
+                            Evaluate(workers[worker], batch);
+                        });
+                    }
+
+                    pool.Wait();
+
+                    Batches   += (entries.size() + Options.BatchSize - 1) / Options.BatchSize;
+                    Positions += entries.size();
+
+                    {
+                        std::lock_guard<std::mutex> guard(Lock);
+                        for (Request* request : round) request->Done = true;
+                    }
+
+                    Completed.notify_all();
+
+                    round  .clear();
+                    entries.clear();
+                }
+            }
+
+            /// \brief Encode the counters of the server.
+            std::string EncodeStatistics() const
+            {
+                const ServiceStatistics statistics = Statistics();
+
+                std::string payload;
+                EvaluationProtocol::Append(payload, statistics.Requests    );
+                EvaluationProtocol::Append(payload, statistics.Positions   );
+                EvaluationProtocol::Append(payload, statistics.Batches     );
+                EvaluationProtocol::Append(payload, statistics.TotalLatency);
+                EvaluationProtocol::Append(payload, statistics.MaxLatency  );
+                EvaluationProtocol::Append(payload, statistics.Uptime      );
+                EvaluationProtocol::Append(payload, statistics.Clients     );
+                return payload;
+            }
+
+            /// \brief The loop serving a client.
+            /// \param client The socket of the client.
+            void Serve(const int client)
+            {
+                Request request;
+
+                uint8_t     type;
+                std::string payload;
+                while (EvaluationProtocol::ReadMessage(client, type, payload)) {
+                    const auto start = Clock::now();
+
+                    const auto requestType = static_cast<RequestType>(type);
+                    if (requestType == RequestType::Statistics) {
+                        if (!EvaluationProtocol::WriteMessage(client, static_cast<uint8_t>(ResponseStatus::Ok),
+                                                              EncodeStatistics())) break;
+                        continue;
+                    }
+
+                    if ((requestType != RequestType::Fens && requestType != RequestType::Features) ||
+                        !Decode(requestType, payload, request)) {
+                        if (!EvaluationProtocol::WriteMessage(client, static_cast<uint8_t>(ResponseStatus::Malformed),
+                                                              {})) break;
+                        continue;
+                    }
+
+                    if (request.Evaluable > 0) {
+                        std::unique_lock<std::mutex> guard(Lock);
+                        if (Stopping) break;
+
+                        Queue.push_back(&request);
+                        QueuedPositions += request.Evaluable;
+                        Arrived.notify_one();
+
+                        Completed.wait(guard, [&request] { return request.Done; });
+                    }
+
+                    const auto latency = static_cast<uint64_t>(
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+
+                    Requests     += 1;
+                    TotalLatency += latency;
+
+                    uint64_t max = MaxLatency.load(std::memory_order_relaxed);
+                    while (latency > max && !MaxLatency.compare_exchange_weak(max, latency));
+
+                    if (!EvaluationProtocol::WriteMessage(client, static_cast<uint8_t>(ResponseStatus::Ok),
+                                                          Encode(request))) break;
+                }
+
+                close(client);
+
+                std::lock_guard<std::mutex> guard(Lock);
+                Connections.erase(client);
+                Finished.push_back(std::this_thread::get_id());
+            }
+
+            /// \brief Join the connection threads that finished.
+            void Reap(std::list<std::thread>& threads)
+            {
+                std::vector<std::thread::id> finished;
+                {
+                    std::lock_guard<std::mutex> guard(Lock);
+                    finished.swap(Finished);
+                }
+
+                for (const std::thread::id id : finished) {
+                    const auto thread = std::find_if(threads.begin(), threads.end(),
+                                                     [id](const std::thread& t) { return t.get_id() == id; });
+                    thread->join();
+                    threads.erase(thread);
+                }
+            }
+
+        public:
+            /// \brief Constructs a new EvaluationServer.
+            /// \param network The network to evaluate with, which must outlive the server.
+            /// \param options The options of the server.
+            __attribute__((unused)) explicit EvaluationServer(const Network& network,
+                                                              const EvaluationServerOptions options =
+                                                                      EvaluationServerOptions()) :
+            Net(&network), Options(options)
+            {
+                Options.Threads      = std::max<size_t>(Options.Threads  , 1);
+                Options.BatchSize    = std::max<size_t>(Options.BatchSize, 1);
+                Options.MaxCoalesced = std::max(Options.MaxCoalesced, Options.BatchSize);
+            }
+
+            EvaluationServer(const EvaluationServer&) = delete;
+            EvaluationServer& operator=(const EvaluationServer&) = delete;
+
+            /// \brief Serve clients until the server is stopped.
+            /// \param path The path of the socket, which is replaced if it exists.
+            /// \return Whether the socket could be created.
+            __attribute__((unused)) bool Run(const std::string& path)
+            {
+                sockaddr_un address {};
+                address.sun_family = AF_UNIX;
+                if (path.size() >= sizeof(address.sun_path)) return false;
+                std::copy(path.begin(), path.end(), address.sun_path);
+
+                const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+                if (listener < 0) return false;
+
+                unlink(path.c_str());
+                if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+                    listen(listener, SOMAXCONN) != 0) {
+                    close(listener);
+                    return false;
+                }
+
+                {
+                    std::lock_guard<std::mutex> guard(Lock);
+                    if (Stopping) {
+                        close(listener);
+                        unlink(path.c_str());
+                        return true;
+                    }
+
+                    Listener = listener;
+                    Started  = Clock::now();
+                }
+
+                std::thread batcher(&EvaluationServer::Batch, this);
+                std::list<std::thread> threads;
+
+                while (true) {
+                    const int client = accept(listener, nullptr, nullptr);
+                    if (client < 0 && errno == EINTR) continue;
+
+                    // Stopping shuts the listener down, which fails the accept:
+                    if (client < 0) break;
+
+                    Reap(threads);
+
+                    std::lock_guard<std::mutex> guard(Lock);
+                    if (Stopping) {
+                        close(client);
+                        break;
+                    }
+
+                    Connections.insert(client);
+                    threads.emplace_back(&EvaluationServer::Serve, this, client);
+                }
+
+                for (std::thread& thread : threads) thread.join();
+                batcher.join();
+
+                close(listener);
+                unlink(path.c_str());
+                return true;
+            }
+
+            /// \brief Stop the server, finishing the requests in flight and disconnecting every client.
+            /// \details This function may be called from any thread, but not from a signal handler.
+            __attribute__((unused)) void Stop()
+            {
+                {
+                    std::lock_guard<std::mutex> guard(Lock);
+                    Stopping = true;
+
+                    if (Listener >= 0) shutdown(Listener, SHUT_RDWR);
+                    for (const int client : Connections) shutdown(client, SHUT_RDWR);
+                }
+
+                Arrived.notify_all();
+            }
+
+            /// \brief The counters of the server.
+            /// \details This function may be called from any thread.
+            [[nodiscard]] __attribute__((unused)) ServiceStatistics Statistics() const
+            {
+                ServiceStatistics statistics;
+                statistics.Requests     = Requests;
+                statistics.Positions    = Positions;
+                statistics.Batches      = Batches;
+                statistics.TotalLatency = TotalLatency;
+                statistics.MaxLatency   = MaxLatency;
+
+                std::lock_guard<std::mutex> guard(Lock);
+                statistics.Uptime  = static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - Started).count());
+                statistics.Clients = Connections.size();
+                return statistics;
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_EVALUATIONSERVER_H
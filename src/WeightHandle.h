@@ -0,0 +1,80 @@
+//
+// Copyright (c) 2023 MantaRay authors. See the list of authors for more details.
+// Licensed under MIT.
+//
+
+#ifndef MANTARAY_WEIGHTHANDLE_H
+#define MANTARAY_WEIGHTHANDLE_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <utility>
+
+namespace MantaRay
+{
+
+    /// \brief A versioned handle to a set of weights that can be replaced while it is in use.
+    /// \tparam Weights The weight type.
+    /// \details The handle works in a read-copy-update fashion: replacing the weights publishes a new, immutable set
+    ///          and bumps the version, while readers that acquired the previous set keep using it until they choose
+    ///          to synchronize, typically at the root of their next search. The previous set is freed once its last
+    ///          reader lets go of it. Checking for a new version is a single relaxed atomic load, so it is safe to
+    ///          do at every root; acquiring the weights only happens when the version changed.
+    template<typename Weights>
+    class WeightHandle
+    {
+
+        private:
+            mutable std::mutex Lock;
+
+            std::shared_ptr<const Weights> Current;
+
+            std::atomic<uint64_t> CurrentVersion = 1;
+
+        public:
+            /// \brief Constructs a new WeightHandle.
+            /// \param weights The initial weights.
+            __attribute__((unused)) explicit WeightHandle(std::shared_ptr<const Weights> weights) :
+            Current(std::move(weights)) {}
+
+            /// \brief Replace the weights.
+            /// \param weights The new weights.
+            /// \details The new weights are published to readers synchronizing after this call. Readers that are
+            ///          currently using the previous weights are not affected, and this call never waits for them.
+            __attribute__((unused)) void Swap(std::shared_ptr<const Weights> weights)
+            {
+                std::shared_ptr<const Weights> previous;
+
+                {
+                    std::lock_guard<std::mutex> guard(Lock);
+                    previous = std::exchange(Current, std::move(weights));
+                    CurrentVersion.fetch_add(1, std::memory_order_release);
+                }
+
+                // The previous weights are released outside the lock, freeing them if no reader holds them anymore.
+            }
+
+            /// \brief The version of the current weights.
+            /// \return The version, which changes every time the weights are replaced.
+            [[nodiscard]] __attribute__((unused)) inline uint64_t Version() const
+            {
+                return CurrentVersion.load(std::memory_order_relaxed);
+            }
+
+            /// \brief Acquire the current weights.
+            /// \param version The version of the acquired weights.
+            /// \return The current weights, which stay alive for as long as the returned pointer is held.
+            [[nodiscard]] __attribute__((unused)) std::shared_ptr<const Weights> Acquire(uint64_t& version) const
+            {
+                std::lock_guard<std::mutex> guard(Lock);
+                version = CurrentVersion.load(std::memory_order_relaxed);
+                return Current;
+            }
+
+    };
+
+} // MantaRay
+
+#endif //MANTARAY_WEIGHTHANDLE_H